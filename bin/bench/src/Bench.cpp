@@ -0,0 +1,456 @@
+#include <splashouille/Library.hpp>
+#include <splashouille/Engine.hpp>
+#include <splashouille/Animation.hpp>
+#include <splashouille/Defines.hpp>
+
+#include <Bench.hpp>
+#include <Stress.hpp>
+
+#include <libconfig.h++>
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <getopt.h>
+#include <time.h>
+
+using namespace splashouille;
+
+/** The default scenes (the bench is run from the repository root) */
+static const char * defaultScenes[] = { "res/conf/bench.ini", "res/conf/map.ini", "res/conf/tags.ini", "res/conf/mouse.ini", 0 };
+
+/** The profile phases reported by the bench */
+static const Engine::Profile::phaseEnum benchPhases[] =
+    { Engine::Profile::onFrame, Engine::Profile::update, Engine::Profile::render, Engine::Profile::flip };
+static const int nbBenchPhases = sizeof(benchPhases)/sizeof(Engine::Profile::phaseEnum);
+
+/** The kinds of source compared by the blit sweep */
+class BlitKind
+{
+public:
+    const char *    name;           // The kind name
+    bool            colorKey;       // Has the source a colorkey
+    bool            pixelAlpha;     // Has the source an alpha channel
+    Uint8           alpha;          // The surface alpha
+};
+static const BlitKind blitKinds[] =
+    { { "copy", false, false, 255 }, { "colorkey", true, false, 255 }, { "alpha", false, false, 160 },
+      { "colorkey_alpha", true, false, 160 }, { "pixel_alpha", false, true, 255 }, { 0, false, false, 0 } };
+
+/**
+ * Get a percentile from sorted values
+ * @param _values is the sorted values
+ * @param _percent is the percentile
+ * @return the percentile value
+ */
+static double percentile(const std::vector<double> & _values, int _percent)
+{
+    return _values.empty()?0:_values[(_values.size()*_percent-1)/100];
+}
+
+/**
+ * Build a sprite source in the display format: a gradient with a transparent border (colorkey or
+ * alpha channel), the alpha channel fades in on the inner border
+ * @param _kind is the kind of source
+ * @param _size is the sprite width and height
+ * @return the surface
+ */
+static SDL_Surface * createSource(const BlitKind & _kind, int _size)
+{
+    SDL_Surface * ret;
+    SDL_Surface * tmp = SDL_CreateRGBSurface(SDL_SWSURFACE, _size, _size, 32, 0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000);
+
+    SDL_LockSurface(tmp);
+    for (int y=0; y<_size; y++)
+    for (int x=0; x<_size; x++)
+    {
+        int     edge    = std::min(std::min(x, y), std::min(_size-1-x, _size-1-y));
+        Uint8   alpha   = edge<_size/8?0:(edge<_size/4?edge*255/(_size/4):255);
+        Uint32  pixel   = SDL_MapRGBA(tmp->format, x*255/_size, y*255/_size, (x+y)*127/_size, alpha);
+
+        if (_kind.colorKey && edge<_size/8) { pixel = SDL_MapRGBA(tmp->format, 255, 0, 255, 255); }
+        *(reinterpret_cast<Uint32*>(static_cast<Uint8*>(tmp->pixels)+y*tmp->pitch)+x) = pixel;
+    }
+    SDL_UnlockSurface(tmp);
+
+    // THE COLORKEY IS SET AS THE IMAGES DO
+    ret = _kind.pixelAlpha?SDL_DisplayFormatAlpha(tmp):SDL_DisplayFormat(tmp);
+    if (_kind.colorKey) { SDL_SetColorKey(ret, SDL_RLEACCEL | SDL_SRCCOLORKEY, SDL_MapRGB(ret->format, 255, 0, 255)); }
+    SDL_FreeSurface(tmp);
+
+    return ret;
+}
+
+/**
+ * Get the largest difference of a color channel between two surfaces of the same format and size
+ * @param _first is the first surface
+ * @param _second is the second surface
+ * @return the largest difference
+ */
+static int getMaxDifference(SDL_Surface * _first, SDL_Surface * _second)
+{
+    int ret     = 0;
+    int size    = _first->format->BytesPerPixel;
+
+    SDL_LockSurface(_first);
+    SDL_LockSurface(_second);
+    for (int y=0; y<_first->h; y++)
+    for (int x=0; x<_first->w; x++)
+    {
+        Uint32  pixels[2] = { 0, 0 };
+        Uint8   rgb[2][3];
+        memcpy(&pixels[0], static_cast<Uint8*>(_first->pixels)+y*_first->pitch+x*size, size);
+        memcpy(&pixels[1], static_cast<Uint8*>(_second->pixels)+y*_second->pitch+x*size, size);
+        SDL_GetRGB(pixels[0], _first->format, &rgb[0][0], &rgb[0][1], &rgb[0][2]);
+        SDL_GetRGB(pixels[1], _second->format, &rgb[1][0], &rgb[1][1], &rgb[1][2]);
+        for (int c=0; c<3; c++) { ret = std::max(ret, std::abs(rgb[0][c]-rgb[1][c])); }
+    }
+    SDL_UnlockSurface(_second);
+    SDL_UnlockSurface(_first);
+
+    return ret;
+}
+
+/**
+ * Callback called each second
+ * @param _frame is the frame number from the beginning of the animation
+ * @param _frameSec is the number of frames played during the last second
+ * @param _second is the current second
+ * @param _profile is the summary of the last frames phases duration
+ */
+void Bench::onSecond(int _frame UNUSED, int _frameSec UNUSED, int _second UNUSED,
+                     const splashouille::Engine::Profile * _profile UNUSED)
+{
+    if (verbose) { std::cerr<<"bench (second: "<<_second<<") (frame: "<<_frame<<")"<<std::endl; }
+}
+
+/**
+ * Callback called on each frame
+ * @param _frame is the frame number from the beginning of the animation
+ * @param _timeStampInMilliSeconds is the current timestamp
+ */
+void Bench::onFrame(int _frame UNUSED, int _timeStampInMilliSeconds UNUSED)
+{
+    // THE FRAMES ARE RUN BACK TO BACK: THE DELTA IS THE DURATION OF THE PREVIOUS FRAME
+    double now = getTime();
+    if (_frame) { frameTimes.push_back(now-lastFrameTime); }
+    lastFrameTime = now;
+}
+
+/**
+ * The onEvent Callback
+ * @param _event is the SDL_Event
+ */
+bool Bench::onEvent(SDL_Event & _event UNUSED, int _timeStampInMilliSeconds UNUSED) { return false; }
+
+/**
+ * Callback on the quit event
+ * @return true if the event is consumed
+ */
+bool Bench::onStop() { return false; }
+
+/**
+ * Get the monotonic time
+ * @return the time in milliseconds
+ */
+double Bench::getTime()
+{
+    timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec*1000.0 + t.tv_nsec/1000000.0;
+}
+
+/**
+ * Print the header of the results
+ */
+void Bench::printHeader()
+{
+    std::cout<<"scene,frames,wall_ms,fps,frame_min_ms,frame_avg_ms,frame_p50_ms,frame_p95_ms,frame_p99_ms,frame_max_ms";
+    for (int i=0; i<nbBenchPhases; i++) { std::cout<<","<<Engine::Profile::getName(benchPhases[i])<<"_avg_ms"; }
+    std::cout<<",blits,blitted_pixels,update_rects,updated_pixels,full_updates"<<std::endl;
+}
+
+/**
+ * Run an engine headless and print its results
+ * @param _name is the scene name
+ * @param _engine is the prepared engine
+ * @param _screen is the rendering surface
+ * @param _update is the average update duration (output, optional)
+ * @param _render is the average render duration (output, optional)
+ */
+void Bench::measure(const std::string & _name, splashouille::Engine * _engine, SDL_Surface * _screen,
+                    double * _update, double * _render)
+{
+    double begin, end, sum = 0;
+
+    frameTimes.clear();
+    frameTimes.reserve(nbFrames);
+
+    _engine->addListener(this);
+    begin = getTime();
+    _engine->runHeadless(_screen, nbFrames, step, -1, Animation::color);
+    end = getTime();
+    if (lastFrameTime>0) { frameTimes.push_back(end-lastFrameTime); lastFrameTime = 0; }
+    _engine->deleteListener(this);
+
+    const Engine::Profile * profile = _engine->getProfile();
+
+    std::sort(frameTimes.begin(), frameTimes.end());
+    for (unsigned int i=0; i<frameTimes.size(); i++) { sum += frameTimes[i]; }
+
+    std::cout<<std::fixed<<std::setprecision(4)
+             <<_name<<","<<profile->nbFrames<<","<<(end-begin)<<","<<(end>begin?profile->nbFrames*1000.0/(end-begin):0)
+             <<","<<(frameTimes.empty()?0:frameTimes.front())
+             <<","<<(frameTimes.empty()?0:sum/frameTimes.size())
+             <<","<<percentile(frameTimes, 50)<<","<<percentile(frameTimes, 95)<<","<<percentile(frameTimes, 99)
+             <<","<<(frameTimes.empty()?0:frameTimes.back());
+    for (int i=0; i<nbBenchPhases; i++) { std::cout<<","<<profile->avg[benchPhases[i]]; }
+    std::cout<<","<<profile->nbBlits<<","<<profile->nbBlittedPixels<<","<<profile->nbUpdateRects
+             <<","<<profile->nbUpdatedPixels<<","<<profile->nbFullUpdates<<std::endl;
+
+    if (_update) { *_update = profile->avg[Engine::Profile::update]; }
+    if (_render) { *_render = profile->avg[Engine::Profile::render]; }
+}
+
+/**
+ * Load a scene from a configuration file and measure it
+ * @param _filename is the configuration file
+ * @param _screen is the rendering surface
+ * @return true if the scene has been loaded
+ */
+bool Bench::runScene(const std::string & _filename, SDL_Surface * _screen)
+{
+    bool                rc              = true;
+    libconfig::Config * configuration   = new libconfig::Config();
+
+    try { configuration->readFile(_filename.c_str()); }
+    catch(libconfig::FileIOException e) { std::cerr<<_filename<<": "<<e.what()<<std::endl; rc = false; }
+    catch(libconfig::ParseException  e) { std::cerr<<_filename<<": "<<e.what()<<std::endl; rc = false; }
+
+    if (rc)
+    {
+        splashouille::Engine * engine = splashouille::Engine::createEngine();
+        engine->setLocale("en");
+
+        if (!(rc = engine->import(configuration))) { std::cerr<<_filename<<": error on import"<<std::endl; }
+        else                                       { measure(_filename, engine, _screen); }
+
+        splashouille::Engine::deleteEngine(engine);
+    }
+
+    delete configuration;
+    return rc;
+}
+
+/**
+ * Build a stress scene and measure it
+ * @param _stress is the stress scene parameters
+ * @param _screen is the rendering surface
+ * @param _update is the average update duration (output, optional)
+ * @param _render is the average render duration (output, optional)
+ */
+void Bench::runStress(const splashouille::Stress & _stress, SDL_Surface * _screen, double * _update, double * _render)
+{
+    splashouille::Engine * engine = splashouille::Engine::createEngine();
+
+    _stress.build(engine, _screen->w, _screen->h);
+    measure(_stress.getName(), engine, _screen, _update, _render);
+
+    splashouille::Engine::deleteEngine(engine);
+}
+
+/**
+ * Run the stress scenes varying one parameter at a time
+ * @param _screen is the rendering surface
+ */
+void Bench::runStressSweep(SDL_Surface * _screen)
+{
+    static const int    objects[]   = { 1000, 3000, 10000, 30000, 100000, 0 };
+    static const int    tags[]      = { 1, 8, 64, 512, 0 };
+    static const int    zSpreads[]  = { 1, 10, 100, 10000, 0 };
+    static const int    depths[]    = { 0, 1, 2, 4, 6, -1 };
+    static const int    movings[]   = { 0, 10, 50, 100, -1 };
+    static const int    imagess[]   = { 0, 50, 100, -1 };
+
+    Stress              base;
+    double              update[2], render[2];
+    int                 first = 0, last = 0;
+
+    base.nbObjects = nbObjectsMax<10000?nbObjectsMax:10000;
+
+    // NUMBER OF OBJECTS: THE LOG-LOG SLOPE IS THE SCALING EXPONENT (1 IS LINEAR, 2 IS QUADRATIC)
+    for (int i=0; objects[i] && objects[i]<=nbObjectsMax; i++)
+    {
+        Stress stress = base; stress.nbObjects = objects[i];
+        runStress(stress, _screen, &update[i?1:0], &render[i?1:0]);
+        if (!i) { first = objects[i]; } last = objects[i];
+    }
+    if (last>first && update[0]>0 && render[0]>0)
+    {
+        std::cout<<"# scaling objects update "<<std::log(update[1]/update[0])/std::log(static_cast<double>(last)/first)
+                 <<" render "<<std::log(render[1]/render[0])/std::log(static_cast<double>(last)/first)<<std::endl;
+    }
+
+    // THE OTHER DIMENSIONS AT A CONSTANT NUMBER OF OBJECTS
+    for (int i=0; tags[i]; i++)         { Stress stress = base; stress.nbTags = tags[i]; runStress(stress, _screen); }
+    for (int i=0; zSpreads[i]; i++)     { Stress stress = base; stress.zSpread = zSpreads[i]; runStress(stress, _screen); }
+    for (int i=0; depths[i]>=0; i++)    { Stress stress = base; stress.depth = depths[i]; runStress(stress, _screen); }
+    for (int i=1; depths[i]>=0; i++)    { Stress stress = base; stress.depth = depths[i]; stress.dynamic = true;
+                                          runStress(stress, _screen); }
+    for (int i=0; movings[i]>=0; i++)   { Stress stress = base; stress.moving = movings[i]; runStress(stress, _screen); }
+    for (int i=0; imagess[i]>=0; i++)   { Stress stress = base; stress.images = imagess[i]; runStress(stress, _screen); }
+}
+
+/**
+ * Compare the engine blitter with the SDL blitters for each kind of source and some sizes
+ * @param _screen is the rendering surface (its format is the destination format)
+ */
+void Bench::runBlitSweep(SDL_Surface * _screen)
+{
+    static const int    sizes[]     = { 16, 64, 256, 0 };
+    static const double nbPixels    = 1<<26;        // The number of pixels blitted by each measure
+
+    // THE SAME BLITS ARE DONE BY SDL IN THE FIRST TARGET, BY THE ENGINE IN THE SECOND ONE
+    SDL_Surface * targets[2] = { SDL_DisplayFormat(_screen), SDL_DisplayFormat(_screen) };
+
+    std::cout<<"blit,size,blits,sdl_ms,engine_ms,sdl_mpixels_s,engine_mpixels_s,speedup,max_diff"<<std::endl;
+
+    for (int k=0; blitKinds[k].name; k++)
+    for (int s=0; sizes[s] && sizes[s]<=_screen->w && sizes[s]<=_screen->h; s++)
+    {
+        int     size        = sizes[s];
+        int     nbBlits     = static_cast<int>(nbPixels/(size*size));
+        double  duration[2];
+
+        for (int t=0; t<2; t++)
+        {
+            SDL_Surface * source = createSource(blitKinds[k], size);
+            SDL_FillRect(targets[t], 0, SDL_MapRGB(targets[t]->format, 32, 64, 96));
+
+            double begin = getTime();
+            for (int i=0; i<nbBlits; i++)
+            {
+                SDL_Rect position;
+                position.x = (i*97)%(_screen->w-size+1);
+                position.y = (i*61)%(_screen->h-size+1);
+                Engine::blitSurface(source, 0, targets[t], &position, blitKinds[k].alpha, t==0);
+            }
+            duration[t] = getTime()-begin;
+
+            SDL_FreeSurface(source);
+        }
+
+        std::cout<<std::fixed<<std::setprecision(4)
+                 <<blitKinds[k].name<<","<<size<<","<<nbBlits<<","<<duration[0]<<","<<duration[1]
+                 <<","<<(duration[0]>0?nbBlits*size*size/(duration[0]*1000):0)
+                 <<","<<(duration[1]>0?nbBlits*size*size/(duration[1]*1000):0)
+                 <<","<<(duration[1]>0?duration[0]/duration[1]:0)
+                 <<","<<getMaxDifference(targets[0], targets[1])<<std::endl;
+    }
+
+    SDL_FreeSurface(targets[0]);
+    SDL_FreeSurface(targets[1]);
+}
+
+/**
+ * Run the bench
+ */
+void Bench::run()
+{
+    // INIT THE SPLASHOUILLE FRAMEWORK WITHOUT DISPLAY
+    splashouille::Engine::init(true);
+
+    // THE DUMMY VIDEO MODE IS NEEDED FOR THE SURFACES CONVERSION
+    SDL_Surface * screen = SDL_SetVideoMode(screenSize[0], screenSize[1], screenDepth, SDL_SWSURFACE );
+    if (!screen) { std::cerr<<"can not create the video surface"<<std::endl; return; }
+
+    if (blit) { runBlitSweep(screen); }
+    else
+    {
+        printHeader();
+
+        if (stress) { runStressSweep(screen); }
+        else
+        {
+            if (filenames.empty()) { for (int i=0; defaultScenes[i]; i++) { filenames.push_back(defaultScenes[i]); } }
+        }
+        for (unsigned int i=0; i<filenames.size(); i++) { runScene(filenames[i], screen); }
+    }
+
+    SDL_Quit();
+}
+
+/**
+ * Parse the command line arguments
+ * @param _argc is the number of arguments
+ * @param _argv is the arguments values
+ * @return true if correct
+ */
+bool Bench::getopt(int _argc, char ** _argv)
+{
+    int     c;
+    bool    ret = true;
+
+    do
+    {
+        int                     option_index = 0;
+        static struct option    long_options[] =
+        { {"size",        1, 0, splashouille::OPTION_SIZE },
+          {"frames",      1, 0, splashouille::OPTION_FRAMES },
+          {"step",        1, 0, splashouille::OPTION_STEP },
+          {"verbose",     0, 0, splashouille::OPTION_VERBOSE },
+          {"stress",      0, 0, splashouille::OPTION_STRESS },
+          {"objects",     1, 0, splashouille::OPTION_OBJECTS },
+          {"blit",        0, 0, splashouille::OPTION_BLIT },
+          {0, 0, 0, 0} };
+
+        c=getopt_long(_argc, _argv, "s:n:t:exo:b", long_options, &option_index);
+
+        switch (c) {
+            case -1:            break;
+            case '?':           ret = false; break;
+            case 0:             break;
+            case OPTION_SIZE:   sscanf(optarg,"%dx%d", &screenSize[0], &screenSize[1]); break;
+            case OPTION_FRAMES: nbFrames = atoi(optarg); break;
+            case OPTION_STEP:   step = atoi(optarg); break;
+            case OPTION_VERBOSE:verbose = true; break;
+            case OPTION_STRESS: stress = true; break;
+            case OPTION_OBJECTS:nbObjectsMax = atoi(optarg); break;
+            case OPTION_BLIT:   blit = true; break;
+            default:            break;
+        }
+    } while(c!=-1);
+
+    if (nbFrames<=0 || step<0) { ret = false; }
+
+    while (optind<_argc) { filenames.push_back(_argv[optind++]); }
+
+    return ret;
+}
+
+/**
+ * The bench main function
+ * @param argc is the number of arguments
+ * @param argv is the argument values
+ * @return 1
+ */
+int main(int argc, char ** argv)
+{
+    Bench *    bench = new Bench();
+    if ( bench->getopt(argc, argv))
+    {
+        bench->run();
+        delete bench;
+    }
+    else
+    {
+        std::cout<<"Usage: bench [--frames N] [--step MS] [--size WxH] [--verbose] [--stress [--objects MAX]] [--blit] [FILE...]"<<std::endl;
+        return 0;
+    }
+
+    return 1;
+}
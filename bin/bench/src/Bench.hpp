@@ -0,0 +1,138 @@
+#ifndef SPLASHOUILLE_BENCH_HPP_
+#define SPLASHOUILLE_BENCH_HPP_
+
+#include <string>
+#include <vector>
+#include <splashouille/Engine.hpp>
+#include <SDL.h>
+
+namespace splashouille
+{
+
+const static char           OPTION_FRAMES       = 'n';
+const static char           OPTION_STEP         = 't';
+const static char           OPTION_SIZE         = 's';
+const static char           OPTION_VERBOSE      = 'e';
+const static char           OPTION_STRESS       = 'x';
+const static char           OPTION_OBJECTS      = 'o';
+const static char           OPTION_BLIT         = 'b';
+
+class Stress;
+
+class Bench : public splashouille::Engine::Listener
+{
+private:
+    int                         screenSize[2];
+    int                         screenDepth;
+    std::vector<std::string>    filenames;
+    int                         nbFrames;
+    int                         step;
+    bool                        verbose;
+    bool                        stress;
+    bool                        blit;
+    int                         nbObjectsMax;
+    std::vector<double>         frameTimes;
+    double                      lastFrameTime;
+public:
+    Bench():screenDepth(32), nbFrames(600), step(40), verbose(false), stress(false), blit(false), nbObjectsMax(10000),
+             lastFrameTime(0)
+    {
+        screenSize[0] = 640;
+        screenSize[1] = 480;
+    }
+
+    /**
+     * Callback called each second
+     * @param _frame is the frame number from the beginning of the animation
+     * @param _frameSec is the number of frames played during the last second
+     * @param _second is the current second
+     * @param _profile is the summary of the last frames phases duration
+     */
+    void onSecond(int _frame, int _frameSec, int _second, const splashouille::Engine::Profile * _profile);
+
+    /**
+     * Callback called on each frame
+     * @param _frame is the frame number from the beginning of the animation
+     * @param _timeStampInMilliSeconds is the current timestamp
+     */
+    void onFrame(int _frame, int _timeStampInMilliSeconds);
+
+    /**
+     * The onEvent Callback
+     * @param _event is the SDL_Event
+     */
+    bool onEvent(SDL_Event & _event, int _timeStampInMilliSeconds);
+
+    /**
+     * Callback on the quit event
+     * @return true if the event is consumed
+     */
+    bool onStop();
+
+    /**
+     * Get the monotonic time
+     * @return the time in milliseconds
+     */
+    static double getTime();
+
+    /**
+     * Print the header of the results
+     */
+    void printHeader();
+
+    /**
+     * Run an engine headless and print its results
+     * @param _name is the scene name
+     * @param _engine is the prepared engine
+     * @param _screen is the rendering surface
+     * @param _update is the average update duration (output, optional)
+     * @param _render is the average render duration (output, optional)
+     */
+    void measure(const std::string & _name, splashouille::Engine * _engine, SDL_Surface * _screen,
+                 double * _update = 0, double * _render = 0);
+
+    /**
+     * Load a scene from a configuration file and measure it
+     * @param _filename is the configuration file
+     * @param _screen is the rendering surface
+     * @return true if the scene has been loaded
+     */
+    bool runScene(const std::string & _filename, SDL_Surface * _screen);
+
+    /**
+     * Build a stress scene and measure it
+     * @param _stress is the stress scene parameters
+     * @param _screen is the rendering surface
+     * @param _update is the average update duration (output, optional)
+     * @param _render is the average render duration (output, optional)
+     */
+    void runStress(const splashouille::Stress & _stress, SDL_Surface * _screen, double * _update = 0, double * _render = 0);
+
+    /**
+     * Run the stress scenes varying one parameter at a time
+     * @param _screen is the rendering surface
+     */
+    void runStressSweep(SDL_Surface * _screen);
+
+    /**
+     * Compare the engine blitter with the SDL blitters for each kind of source and some sizes
+     * @param _screen is the rendering surface (its format is the destination format)
+     */
+    void runBlitSweep(SDL_Surface * _screen);
+
+    /**
+     * Run the bench
+     */
+    void run();
+
+    /**
+     * Parse the command line arguments
+     * @param _argc is the number of arguments
+     * @param _argv is the arguments values
+     * @return true if correct
+     */
+    bool getopt(int _argc, char ** _argv);
+};
+}
+
+#endif
@@ -0,0 +1,150 @@
+#include <splashouille/Library.hpp>
+#include <splashouille/Crowd.hpp>
+#include <splashouille/Object.hpp>
+#include <splashouille/Solid.hpp>
+#include <splashouille/Image.hpp>
+#include <splashouille/Style.hpp>
+#include <splashouille/Fashion.hpp>
+#include <splashouille/Animation.hpp>
+#include <splashouille/Engine.hpp>
+
+#include <Stress.hpp>
+
+#include <sstream>
+
+using namespace splashouille;
+
+/** The image used by the stress scenes (the bench is run from the repository root) */
+static const char * stressImage = "res/img/sphere.bmp";
+
+/**
+ * Get a deterministic pseudo random number
+ * @param _max is the upper bound (excluded)
+ * @return a number in [0, _max[
+ */
+int Stress::random(int _max) const
+{
+    seed = seed*1103515245 + 12345;
+    return _max>0?static_cast<int>((seed>>16)%_max):0;
+}
+
+/**
+ * Get the scene name with its parameters
+ * @return the scene name
+ */
+std::string Stress::getName() const
+{
+    std::ostringstream ret;
+    ret<<"stress;objects="<<nbObjects<<";tags="<<nbTags<<";z="<<zSpread<<";depth="<<depth
+       <<";nest="<<(dynamic?"dynamic":"static")<<";moving="<<moving<<";images="<<images;
+    return ret.str();
+}
+
+/**
+ * Create the objects of a leaf animation
+ * @param _animation is the leaf animation
+ * @param _nbObjects is the number of objects to create
+ * @param _width is the scene width
+ * @param _height is the scene height
+ */
+void Stress::fill(splashouille::Animation * _animation, int _nbObjects, int _width, int _height) const
+{
+    Library * library = _animation->getLibrary();
+
+    for (int i=0; i<_nbObjects; i++)
+    {
+        std::ostringstream  id;
+        std::ostringstream  tag;
+        Object *            object  = 0;
+        int                 size    = 8 + random(25);
+
+        id<<"stress"<<nbCreated++;
+        tag<<"tag"<<random(nbTags);
+
+        if (random(100)<images)
+        {
+            Image * image = library->createImage(id.str());
+            if (image->setFilename(stressImage))    { image->setAlphaColor(); object = image; size = 64; }
+            else                                    { library->deleteObject(image); }
+        }
+        if (!object)
+        {
+            object = library->createSolid(id.str());
+            object->getStyle()->setBackgroundColor(random(256), random(256), random(256));
+        }
+
+        int x = random(_width>size?_width-size:1);
+        int y = random(_height>size?_height-size:1);
+
+        object->getStyle()->setLeft(x);
+        object->getStyle()->setTop(y);
+        object->getStyle()->setWidth(size);
+        object->getStyle()->setHeight(size);
+        object->setTag(tag.str());
+        object->setZIndex(random(zSpread));
+
+        // THE MOVING OBJECTS GO BACK AND FORTH WITH DIFFERENT PERIODS
+        if (random(100)<moving)
+        {
+            int period  = 500 + random(1500);
+            int dx      = random(_width/4) - _width/8;
+            int dy      = random(_height/4) - _height/8;
+            Style * style;
+
+            style = object->getFashion()->addTransition(0, period/2, 0, 0, period);
+            style->setLeft(x+dx); style->setTop(y+dy);
+            style = object->getFashion()->addTransition(period/2, period, 0, 0, period);
+            style->setLeft(x); style->setTop(y);
+        }
+
+        _animation->getCrowd()->insertObject(0, object);
+    }
+}
+
+/**
+ * Create the animation tree
+ * @param _animation is the parent animation
+ * @param _depth is the remaining depth
+ * @param _nbObjects is the number of objects to dispatch in the subtree
+ * @param _width is the scene width
+ * @param _height is the scene height
+ */
+void Stress::nest(splashouille::Animation * _animation, int _depth, int _nbObjects, int _width, int _height) const
+{
+    if (_depth<=0) { fill(_animation, _nbObjects, _width, _height); }
+    else
+    {
+        // BINARY TREE: EACH CHILD GETS HALF OF THE OBJECTS
+        for (int i=0; i<2; i++)
+        {
+            std::ostringstream  id;
+            id<<"stress_"<<_animation->getId()<<"_"<<i;
+
+            Animation * child = _animation->getLibrary()->createAnimation(id.str());
+            child->setAnimationType(dynamic?Animation::dynamic:Animation::group);
+            child->getStyle()->setLeft(0);
+            child->getStyle()->setTop(0);
+            child->getStyle()->setWidth(_width);
+            child->getStyle()->setHeight(_height);
+            child->setZIndex(random(zSpread));
+
+            nest(child, _depth-1, i?_nbObjects-_nbObjects/2:_nbObjects/2, _width, _height);
+            _animation->getCrowd()->insertObject(0, child);
+        }
+    }
+}
+
+/**
+ * Build the scene in an empty engine
+ * @param _engine is the engine
+ * @param _width is the scene width
+ * @param _height is the scene height
+ */
+void Stress::build(splashouille::Engine * _engine, int _width, int _height) const
+{
+    // THE SAME PARAMETERS ALWAYS BUILD THE SAME SCENE
+    seed        = 1;
+    nbCreated   = 0;
+
+    nest(_engine, depth, nbObjects, _width, _height);
+}
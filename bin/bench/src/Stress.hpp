@@ -0,0 +1,76 @@
+#ifndef SPLASHOUILLE_STRESS_HPP_
+#define SPLASHOUILLE_STRESS_HPP_
+
+#include <string>
+#include <splashouille/Engine.hpp>
+
+namespace splashouille
+{
+
+class Animation;
+
+/**
+ * The stress scene generator: build a synthetic crowd through the splashouille API
+ */
+class Stress
+{
+public:
+    int                         nbObjects;      // The number of solid and image objects
+    int                         nbTags;         // The number of tags shared by the objects
+    int                         zSpread;        // The number of distinct z-index values
+    int                         depth;          // The depth of the animation tree (binary tree)
+    bool                        dynamic;        // Are the nested animations dynamic (static otherwise)
+    int                         moving;         // The percentage of moving objects
+    int                         images;         // The percentage of images (solids otherwise)
+
+private:
+    mutable unsigned int        seed;           // The pseudo random generator seed
+    mutable int                 nbCreated;      // The number of created objects
+
+    /**
+     * Get a deterministic pseudo random number
+     * @param _max is the upper bound (excluded)
+     * @return a number in [0, _max[
+     */
+    int random(int _max) const;
+
+    /**
+     * Create the objects of a leaf animation
+     * @param _animation is the leaf animation
+     * @param _nbObjects is the number of objects to create
+     * @param _width is the scene width
+     * @param _height is the scene height
+     */
+    void fill(splashouille::Animation * _animation, int _nbObjects, int _width, int _height) const;
+
+    /**
+     * Create the animation tree
+     * @param _animation is the parent animation
+     * @param _depth is the remaining depth
+     * @param _nbObjects is the number of objects to dispatch in the subtree
+     * @param _width is the scene width
+     * @param _height is the scene height
+     */
+    void nest(splashouille::Animation * _animation, int _depth, int _nbObjects, int _width, int _height) const;
+
+public:
+    Stress():nbObjects(1000), nbTags(1), zSpread(1), depth(0), dynamic(false), moving(10), images(0),
+             seed(0), nbCreated(0) {}
+
+    /**
+     * Get the scene name with its parameters
+     * @return the scene name
+     */
+    std::string getName() const;
+
+    /**
+     * Build the scene in an empty engine
+     * @param _engine is the engine
+     * @param _width is the scene width
+     * @param _height is the scene height
+     */
+    void build(splashouille::Engine * _engine, int _width, int _height) const;
+};
+}
+
+#endif
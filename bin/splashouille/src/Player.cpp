@@ -25,12 +25,20 @@ using namespace splashouille;
  * @param _frame is the frame number from the beginning of the animation
  * @param _frameSec is the number of frames played during the last second
  * @param _second is the current second
+ * @param _profile is the summary of the last frames phases duration
  */
-void Player::onSecond(int _frame UNUSED, int _frameSec UNUSED, int _second UNUSED)
+void Player::onSecond(int _frame UNUSED, int _frameSec UNUSED, int _second UNUSED,
+                      const splashouille::Engine::Profile * _profile UNUSED)
 {
     if (verbose)
     {
-        std::cout<<"splashouille (second: "<<_second<<") (frame: "<<_frame<<") (fps: "<<_frameSec<<")"<<std::endl;
+        std::cout<<"splashouille (second: "<<_second<<") (frame: "<<_frame<<") (fps: "<<_frameSec<<")";
+        if (_profile)
+        {
+            std::cout<<" (frame avg: "<<_profile->avg[Engine::Profile::total]<<"ms)"
+                     <<" (frame p99: "<<_profile->p99[Engine::Profile::total]<<"ms)";
+        }
+        std::cout<<std::endl;
     }
 }
 
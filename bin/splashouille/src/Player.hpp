@@ -38,8 +38,9 @@ public:
      * @param _frame is the frame number from the beginning of the animation
      * @param _frameSec is the number of frames played during the last second
      * @param _second is the current second
+     * @param _profile is the summary of the last frames phases duration
      */
-    void onSecond(int _frame, int _frameSec, int _second);
+    void onSecond(int _frame, int _frameSec, int _second, const splashouille::Engine::Profile * _profile);
 
     /**
      * Callback called on each frame
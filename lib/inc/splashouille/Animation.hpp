@@ -70,6 +70,12 @@ public:
     /** @return the animation type */
     virtual splashouille::Animation::animationType getAnimationType() const = 0;
 
+    /**
+     * Set the animation type (to call before inserting in the crowd)
+     * @param _animationType is the new animation type
+     */
+    virtual void setAnimationType(splashouille::Animation::animationType _animationType) = 0;
+
     /**
      * Change the current timeline
      * @param _timelineId is the timeline Id as String
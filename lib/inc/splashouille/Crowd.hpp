@@ -21,6 +21,7 @@ SPLASHOUILLE.  If not, see http://www.gnu.org/licenses/
 #include <splashouille/Defines.hpp>
 #include <splashouille/Object.hpp>
 #include <string>
+#include <vector>
 
 class SDL_Surface;
 
@@ -59,6 +60,14 @@ public:
      */
     virtual bool insertObject(int _timestamp, splashouille::Object * _object) = 0;
 
+    /**
+     * Insert a batch of active objects into the crowd (cheaper than one by one for large batches)
+     * @param _timestamp is the insertion timestamp
+     * @param _objects is the objects list
+     * @return the number of inserted objects
+     */
+    virtual int insertObjects(int _timestamp, const std::vector<splashouille::Object*> & _objects) = 0;
+
     /**
      * Get an object from its id
      * @param _id is the object to get
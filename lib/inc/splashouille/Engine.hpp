@@ -45,6 +45,40 @@ public:
      */
     enum mouseModeEnum { none = 0, inactive, active, object };
 
+    /**
+     * The frame profile class
+     * Summary of the duration (in milliseconds) of each phase of the last frames
+     */
+    class Profile
+    {
+    public:
+        /** The frame phases : events: SDL events polling, mouseEvent: mouse event propagation,
+         *  onFrame: onFrame listeners, update: timelines, crowds and fashions update, render: surfaces
+         *  rendering, flip: screen update, total: the whole frame
+         */
+        enum phaseEnum { events = 0, mouseEvent, onFrame, update, render, flip, total, last };
+
+        int         nbSamples;          // The number of frames in the summary
+        double      min[last];          // The minimum duration of each phase
+        double      avg[last];          // The average duration of each phase
+        double      p95[last];          // The 95th percentile of each phase
+        double      p99[last];          // The 99th percentile of each phase
+
+        long        nbFrames;           // The number of frames since the beginning of the run
+        long        nbBlits;            // The number of blits since the beginning of the run
+        long        nbBlittedPixels;    // The number of blitted pixels since the beginning of the run
+        long        nbUpdateRects;      // The number of screen update rectangles since the beginning of the run
+        long        nbUpdatedPixels;    // The number of updated screen pixels since the beginning of the run
+        long        nbFullUpdates;      // The number of full screen updates since the beginning of the run
+
+        /**
+         * Get the phase name
+         * @param _phase is the phase
+         * @return the name of the phase
+         */
+        static const char * getName(phaseEnum _phase);
+    };
+
     /**
      * The animation listener class
      * Used for getting information and callback durin animation process
@@ -57,8 +91,10 @@ public:
          * @param _frame is the frame number from the beginning of the animation
          * @param _frameSec is the number of frames played during the last second
          * @param _second is the current second
+         * @param _profile is the summary of the last frames phases duration
          */
-        virtual void onSecond(int _frame UNUSED, int _frameSec UNUSED, int _second UNUSED) = 0;
+        virtual void onSecond(int _frame UNUSED, int _frameSec UNUSED, int _second UNUSED,
+                              const splashouille::Engine::Profile * _profile UNUSED) = 0;
 
         /**
          * Callback called on each frame
@@ -81,8 +117,26 @@ public:
         virtual bool onStop() = 0;
     };
 
-    /** splashouille init SDL method */
-    static bool                             init();
+    /**
+     * The clock class
+     * Used for replacing the SDL timer (SDL_GetTicks) by another time source
+     */
+    class Clock
+    {
+    public:
+        /**
+         * Get the current time
+         * @return the current time in milliseconds
+         */
+        virtual Uint32 getTicks() = 0;
+    };
+
+    /**
+     * splashouille init SDL method
+     * @param _headless is true for using the SDL dummy drivers (no window, no sound device)
+     * @return true if succeed
+     */
+    static bool                             init(bool _headless = false);
 
     /** splashouille factory methodes */
     static splashouille::Engine *           createEngine();
@@ -117,6 +171,20 @@ public:
      */
     static bool                             inter(const SDL_Rect * _first, const SDL_Rect * _second);
 
+    /**
+     * Blit a surface as the objects are rendered: with the engine blitter for the 32 bits surfaces,
+     * with SDL for the others
+     * @param _source is the source surface
+     * @param _sourceRect is the source rect (0 for the whole surface)
+     * @param _destination is the destination surface
+     * @param _position is the destination position (0 for the top left corner)
+     * @param _alpha is the surface alpha
+     * @param _sdl is true for forcing the SDL blitters (comparison)
+     */
+    static void                             blitSurface(SDL_Surface * _source, const SDL_Rect * _sourceRect,
+                                                        SDL_Surface * _destination, const SDL_Rect * _position,
+                                                        Uint8 _alpha = SDL_ALPHA_OPAQUE, bool _sdl = false);
+
     /**
      * Set the mouse mode
      * @param _mode is the mouse mode
@@ -167,12 +235,12 @@ public:
     virtual bool deleteListener(splashouille::Engine::Listener * _listener) = 0;
 
     /**
-     * Stop the engine
+     * Stop the engine (an SDL_USEREVENT wakes the run loop up, so it may be called from another thread)
      */
     virtual void stop() = 0;
 
     /**
-     * Pause/Play the engine
+     * Pause/Play the engine (an SDL_USEREVENT wakes the run loop up, so it may be called from another thread)
      */
     virtual void pause() = 0;
 
@@ -183,12 +251,38 @@ public:
     virtual void setFPS(int _fps) = 0;
 
     /**
-     * Run the animation
+     * Set the clock used by the run method
+     * @param _clock is the new clock (0 for the SDL timer)
+     */
+    virtual void setClock(splashouille::Engine::Clock * _clock) = 0;
+
+    /**
+     * Get the duration summary of the last frames phases
+     * @return the frame profile
+     */
+    virtual const splashouille::Engine::Profile * getProfile() = 0;
+
+    /**
+     * Run the animation (while nothing is due in the scene and no input arrives, the frames only call
+     * the listeners: the scene is neither updated nor rendered)
      * @param _surface is the SDL surface for rendering the animation
      * @param _bg for handling the background
      * @return true if everything is fine
      */
     virtual bool run(SDL_Surface * _surface, splashouille::Animation::backgroundEnum _bg = splashouille::Animation::copy ) = 0;
+
+    /**
+     * Run the animation without display: the SDL events are not handled and the time is
+     * a virtual clock increased by a fixed step on each frame (offline rendering, benchmarks)
+     * @param _surface is the offscreen SDL surface for rendering the animation
+     * @param _nbFrames is the number of frames to render (-1 for no limit)
+     * @param _stepInMilliSeconds is the virtual time between two frames (0 needs a number of frames)
+     * @param _timeStampMax is the last timestamp to render (-1 for no limit)
+     * @param _bg for handling the background
+     * @return true if everything is fine
+     */
+    virtual bool runHeadless(SDL_Surface * _surface, int _nbFrames, int _stepInMilliSeconds, int _timeStampMax = -1,
+                             splashouille::Animation::backgroundEnum _bg = splashouille::Animation::copy) = 0;
 };
 
 }
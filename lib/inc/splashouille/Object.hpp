@@ -92,6 +92,18 @@ public:
      */
     virtual int getZIndex() const = 0;
 
+    /**
+     * set the object tag (to call before inserting in the crowd)
+     * @param _tag is the new tag
+     */
+    virtual void setTag(const std::string & _tag) = 0;
+
+    /**
+     * set the z-index (to call before inserting in the crowd, use Crowd::setZIndex otherwise)
+     * @param _zIndex is the new z-index
+     */
+    virtual void setZIndex(int _zIndex) = 0;
+
     /**
      * Get the fashion
      * @return the fashion
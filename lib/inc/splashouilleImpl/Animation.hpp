@@ -21,10 +21,11 @@ SPLASHOUILLE.  If not, see http://www.gnu.org/licenses/
 #include <splashouille/Defines.hpp>
 #include <splashouille/Animation.hpp>
 #include <splashouilleImpl/Object.hpp>
+#include <splashouilleImpl/Region.hpp>
 
 #include <SDL.h>
-#include <map>
 #include <string>
+#include <vector>
 
 namespace splashouille
 {
@@ -38,8 +39,6 @@ class Timeline;
 class Crowd;
 class Library;
 
-const static int    nbUpdateRectsMax = 4096;
-
 /**
  * The animation class implementation
  * Actually, there are two kind of animations: static and not static
@@ -49,12 +48,13 @@ const static int    nbUpdateRectsMax = 4096;
 class Animation : virtual public splashouille::Animation, virtual public splashouilleImpl::Object
 {
 protected:
-    typedef std::map<std::string,Timeline*> TimelineMap;
+    typedef std::tr1::unordered_map<int, Timeline*> TimelineMap;
 
     int                                     numberOfPixels;                 // The number of pixels involved in update
     int                                     nbUpdateRects;                  // The update rects number
-    SDL_Rect                                updateRects[nbUpdateRectsMax];  // The update rects
-    TimelineMap                             timelines;                      // The animation timelines
+    SDL_Rect *                              updateRects;                    // The update rects (owned by the region)
+    Region                                  region;                         // The damaged region (merged update rects)
+    TimelineMap                             timelines;                      // The animation timelines by id symbol
     Timeline *                              timeline;                       // Save the current timeline pointer for perf
     Crowd *                                 crowd;                          // The animation active objects
     splashouille::Library *                 library;                        // A copy of the library pointer
@@ -73,6 +73,12 @@ protected:
      */
     void initTimelines();
 
+    /**
+     * Render the crowd into the surface (in the damaged parts only)
+     * @param _offset is the parent offset
+     */
+    void renderCrowd(SDL_Rect * _offset);
+
 public:
     /** Accessors */
     splashouille::Timeline *                getTimeline();
@@ -80,11 +86,39 @@ public:
     splashouille::Library *                 getLibrary()                { return library; }
     bool                                    isStatic() const            { return (animationType == splashouille::Animation::group); }
     splashouille::Animation::animationType  getAnimationType() const    { return animationType; }
+    void                                    setAnimationType(splashouille::Animation::animationType _t) { animationType = _t; }
     bool                                    isAnimation() const         { return true; }
     void                                    setParent(Animation* _a)    { if (this!=_a) { parent = _a; } }
     void                                    setBg(splashouille::Animation::backgroundEnum _b)   { bg = _b; }
 
-    void                                    clear()                     { numberOfPixels  = 0; nbUpdateRects   = 0; }
+    void                                    clear()                     { numberOfPixels  = 0; nbUpdateRects   = 0; updateRects = 0;
+                                                                          region.clear(); }
+    bool                                    isDamaged() const           { return numberOfPixels>0; }
+
+    /**
+     * Build the update rects from the damaged region (if it has changed)
+     */
+    void prepareUpdateRects()   { updateRects = region.getRects(nbUpdateRects); }
+
+    /**
+     * Get the animation which owns the rendering surface (the closest not static animation or the engine)
+     * @return the owner animation
+     */
+    Animation * getOwner()      { Animation * ret = this; while (ret->isStatic() && ret->parent) { ret = ret->parent; } return ret; }
+
+    /**
+     * Get the update rects (built by prepareUpdateRects)
+     * @return the update rects array
+     */
+    const SDL_Rect * getUpdateRects() const { return updateRects; }
+
+    /**
+     * Find the update rects intersecting an area (built by prepareUpdateRects)
+     * @param _area is the area in the animation surface
+     * @param _indices is the list of the update rects index (output, appended)
+     * @return the number of update rects found
+     */
+    int findUpdateRects(const SDL_Rect * _area, std::vector<int> & _indices) { return region.findRects(_area, _indices); }
 
     /**
      * Handle the mouseEvent
@@ -104,6 +138,12 @@ public:
      */
     bool update(int _timestamp);
 
+    /**
+     * Get the next timestamp the animation, its timeline or its crowd changes at (to call after the update)
+     * @return the timestamp (Fashion::never if nothing changes by itself)
+     */
+    int getWakeTimestamp() const;
+
     /**
      * Add an update rect into the animation
      * @param _updateRect is the updateRect to insert
@@ -126,6 +166,34 @@ public:
      */
     bool render(SDL_Surface * _surface, SDL_Rect * _offset = 0);
 
+    /**
+     * Prepare the render of the object and get its blit command
+     * @param _surface is the surface to fill
+     * @param _offset is the parent offset
+     * @param _command is the blit command (output)
+     * @return true if there is something to blit
+     */
+    bool compile(SDL_Surface * _surface, SDL_Rect * _offset, DisplayList::Command * _command);
+
+    /**
+     * Build the animation surface if it is missing or too small
+     * @param _surface is the parent surface (the surface of the static animations)
+     */
+    void prepareSurface(SDL_Surface * _surface);
+
+    /**
+     * Render the crowd into the animation surface if it is damaged, then clear the damage
+     * (not static animations only, the surface is built first by prepareSurface)
+     */
+    void renderSurface();
+
+    /**
+     * Get the area fully covered by the object when it is rendered (used for the occlusion)
+     * @param _rect is the opaque area in the parent coordinates (output)
+     * @return true if the object is opaque on a not empty area
+     */
+    bool getOpaqueRect(SDL_Rect * _rect);
+
     /**
      * Log the animation to the standard output
      * @param _rank is the log rank
@@ -139,6 +207,13 @@ public:
      */
     bool changeTimeline(const std::string & _timelineId, bool _updateInitialTimeStamp = true);
 
+    /**
+     * Change the current timeline
+     * @param _timelineSymbol is the timeline Id as symbol
+     * @return true if the timeline is found
+     */
+    bool changeTimeline(int _timelineSymbol, bool _updateInitialTimeStamp = true);
+
     /**
      * Forward the callback
      * @return true
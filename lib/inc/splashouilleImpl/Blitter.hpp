@@ -0,0 +1,82 @@
+/*
+Copyright 2011 JohannC
+
+This file is part of SPLASHOUILLE.
+
+SPLASHOUILLE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+SPLASHOUILLE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+SPLASHOUILLE.  If not, see http://www.gnu.org/licenses/
+*/
+
+
+#ifndef SPLASHOUILLEIMPL_BLITTER_HPP_
+#define SPLASHOUILLEIMPL_BLITTER_HPP_
+
+#include <SDL.h>
+
+namespace splashouilleImpl
+{
+
+/**
+ * The engine blitter for the 32 bits surfaces
+ * An object is classified when it is prepared (once per frame), then all its blits (one per update rect
+ * or per screen tile) take the same path: a plain copy of the rows when it is opaque without colorkey,
+ * otherwise a colorkey, surface alpha or pixel alpha kernel (4 pixels at a time with SSE2).
+ * The blends follow the SDL 1.2 blitters of the same format surfaces. The other formats, the RLE
+ * and the hardware surfaces are left to SDL.
+ */
+class Blitter
+{
+public:
+    /**
+     * The blit paths
+     */
+    enum Mode
+    {
+        sdl,                                                            // The SDL blitters
+        copy,                                                           // Opaque without colorkey: copy the rows
+        colorKey,                                                       // Opaque with colorkey
+        alpha,                                                          // Surface alpha without colorkey
+        colorKeyAlpha,                                                  // Surface alpha with colorkey
+        pixelAlpha                                                      // Alpha channel (SDL ignores the surface alpha and the colorkey)
+    };
+
+    /**
+     * Get the blit path of a source
+     * @param _source is the source surface
+     * @param _alpha is the surface alpha
+     * @return the blit path
+     */
+    static Mode classify(const SDL_Surface * _source, Uint8 _alpha);
+
+    /**
+     * Check if the engine blitter can blit a source into a destination (same colors layout, no lock)
+     * @param _source is the source surface
+     * @param _destination is the destination surface
+     * @return true if the engine blitter can be used
+     */
+    static bool accepts(const SDL_Surface * _source, const SDL_Surface * _destination);
+
+    /**
+     * Blit a source (the rects are already clipped)
+     * @param _mode is the blit path (not sdl)
+     * @param _source is the source surface
+     * @param _sourceRect is the source rect
+     * @param _destination is the destination surface
+     * @param _position is the destination position
+     * @param _alpha is the surface alpha
+     */
+    static void blit(Mode _mode, const SDL_Surface * _source, const SDL_Rect * _sourceRect,
+                     SDL_Surface * _destination, const SDL_Rect * _position, Uint8 _alpha);
+};
+
+}
+
+#endif
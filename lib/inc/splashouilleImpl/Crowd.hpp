@@ -19,10 +19,11 @@ SPLASHOUILLE.  If not, see http://www.gnu.org/licenses/
 #define SPLASHOUILLEIMPL_CROWD_HPP_
 
 #include <splashouille/Crowd.hpp>
-#include <map>
-#include <list>
+#include <splashouilleImpl/Symbol.hpp>
+#include <splashouilleImpl/DisplayList.hpp>
+#include <vector>
 
-class SDL_Rect;
+#include <SDL.h>
 
 namespace splashouilleImpl
 {
@@ -31,32 +32,283 @@ class Object;
 
 /**
  * The crowd implementation
+ * The objects are stored in one z-sorted array (and one per tag), so the traversals are linear scans.
+ * The objects and the tags are indexed by their id symbol.
+ * The changes made by the callbacks during a traversal are applied when the last traversal ends.
+ * The objects sleep between the boundaries of their transitions: a wake-up queue sorted by timestamp
+ * gives the objects to update, only the animations and the maps are updated at each frame.
+ * The due objects only change themselves: they are evaluated in parallel, then damaged and scheduled
+ * in the queue order by the calling thread.
+ * The damaged offscreen animations which share no source surface are rendered in parallel before the
+ * render, which then only blits their surfaces in the z-order.
  */
 class Crowd : public splashouille::Crowd
 {
 public:
     static int                                          garbageNumber;      // The number of allocated crowd
 private:
-    std::map<std::string, Object *>                     library;            // All the objects in the crowd
-    std::map<std::string, std::list<Object*>*>          crowd;              // The crowd objects (map by tags, list by zindex)
+    /**
+     * An object of the z-sorted arrays (the equal z-indexes are sorted by insertion)
+     */
+    class Entry
+    {
+    public:
+        Object *                                        object;             // The object (0 if dropped during a traversal)
+        int                                             zIndex;             // The object z-index when placed
+        unsigned int                                    sequence;           // The insertion order
+        Entry(Object * _object);
+        Entry(int _zIndex, unsigned int _sequence):object(0), zIndex(_zIndex), sequence(_sequence) {}
+    };
+    typedef std::vector<Entry>                          Entries;
+
+    /**
+     * A scheduled update of a sleeping object (the object is not dereferenced before it is found in the crowd)
+     */
+    class Wake
+    {
+    public:
+        int                                             timestamp;          // The wake-up timestamp
+        Object *                                        object;             // The object
+        int                                             zIndex;             // The object z-index when scheduled
+        unsigned int                                    sequence;           // The object insertion order when scheduled
+        unsigned int                                    stamp;              // The object wake stamp when scheduled
+        Wake(Object * _object, int _timestamp);
+    };
+    typedef std::vector<Wake>                           Wakes;
+
+    /**
+     * A due sleeping object and the result of its evaluation
+     */
+    class Sleeper
+    {
+    public:
+        Object *                                        object;             // The object
+        int                                             wakeTimestamp;      // The next wake-up timestamp
+        bool                                            changed;            // Has the object changed
+        bool                                            blended;            // Has the style of the object to be blended
+        Sleeper(Object * _object):object(_object), wakeTimestamp(0), changed(false), blended(false) {}
+    };
+    typedef std::vector<Sleeper>                        Sleepers;
+    class Evaluation;
+    class Offscreen;
+    typedef std::tr1::unordered_map<SDL_Surface*, int>  SourceMap;
+    typedef std::tr1::unordered_map<int, Object *>      ObjectMap;
+    typedef std::tr1::unordered_map<int, Entries>       TagMap;
+
+    ObjectMap                                           library;            // All the objects in the crowd
+    Entries                                             objects;            // All the objects sorted by z-index
+    TagMap                                              tags;               // The tagged objects sorted by z-index
+    Entries                                             pending;            // The objects inserted during a traversal
+    Entries                                             containers;         // The animations and the maps sorted by z-index
+    Wakes                                               wakes;              // The wake-up queue (heap sorted by timestamp)
+    Sleepers                                            sleepers;           // The due objects of the running update
+    Entries                                             tagBatch;           // The tagged objects of the current bulk insertion
+    unsigned int                                        sequence;           // The next insertion order
+    mutable int                                         traversals;         // The number of running traversals
+    bool                                                holes;              // Have objects been dropped during a traversal
     Animation *                                         animation;          // The parent animation
+    std::vector<char>                                   hidden;             // Is the object occluded (occlusion pass)
+    std::vector<int>                                    nbOccluders;        // The number of occluders in front of each object
+    std::vector<SDL_Rect>                               occluders;          // The opaque areas of the front objects
+    std::vector<int>                                    rectIndices;        // The update rects under the rendered object
+    std::vector<SDL_Rect>                               clips;              // The visible parts of the rendered object
+    std::vector<Object*>                                subtrees;           // The offscreen animations rendered in parallel
+    bool                                                occlusionReady;     // Has the occlusion pass been done for the next render
+    DisplayList                                         displayList;        // The blit commands of the render
+    const static int                                    nbOccludersMax = 16;// Beyond, the opaque objects do not occlude anymore
+    const static int                                    wakeNow = -0x7fffffff;  // The timestamp of an object woken up
+    const static unsigned int                           nbWakesMin = 64;    // Below, the dropped wake-ups are not purged
+    const static int                                    sleepersGrain = 128;// The number of due objects of a parallel chunk
+
+    /**
+     * Find the parts of an object to render: its area in the update rects of the surface owner,
+     * without the parts covered by an opaque object in front of it
+     * @param _index is the object index in the z-sorted array
+     * @param _owner is the surface owner
+     * @param _surface is the surface to render
+     * @param _offset is the parent offset
+     * @return the number of parts (in clips), -1 if the object is hidden or outside the damaged region
+     */
+    int findClips(unsigned int _index, Animation * _owner, SDL_Surface * _surface, SDL_Rect * _offset);
+
+    /**
+     * Collect the surfaces read by the render of the crowd (recursively) for an offscreen animation
+     * @param _sources is the offscreen animation of each surface (updated)
+     * @param _subtree is the offscreen animation index
+     * @param _dependent is set for the offscreen animations which cannot be rendered in parallel (updated)
+     */
+    void collectSources(SourceMap & _sources, int _subtree, std::vector<char> & _dependent) const;
+
+    /**
+     * Render in parallel the damaged offscreen animations of the crowd which share no source surface
+     * (they are then just blitted by the render)
+     * @param _surface is the surface to render
+     * @param _offset is the parent offset
+     */
+    void renderSubtrees(SDL_Surface * _surface, SDL_Rect * _offset);
+
+    /**
+     * Compare two entries regarding their tag then their z-index and their insertion order
+     * @param _a is the first entry
+     * @param _b is the second entry
+     * @return true if _a is before _b
+     */
+    static bool beforeInTag(const Entry & _a, const Entry & _b);
+
+    /**
+     * Compare two entries regarding their z-index then their insertion order
+     * @param _a is the first entry
+     * @param _b is the second entry
+     * @return true if _a is rendered before _b
+     */
+    static bool before(const Entry & _a, const Entry & _b);
+
+    /**
+     * Compare two wake-ups regarding their timestamp (for the heap functions)
+     * @param _a is the first wake-up
+     * @param _b is the second wake-up
+     * @return true if _a is later than _b
+     */
+    static bool later(const Wake & _a, const Wake & _b) { return _a.timestamp>_b.timestamp; }
+
+    /**
+     * Check if an object sleeps between its updates (the animations and the maps are updated at each frame)
+     * @param _object is the object
+     * @return true if the object is updated by the wake-up queue
+     */
+    static bool isSleeper(const Object * _object);
 
-    typedef std::list<Object*>::iterator                objectIterator;
-    typedef std::pair<objectIterator, objectIterator>   objectParser;
+    /**
+     * Insert an entry in a z-sorted array (binary search of the position)
+     * @param _entries is the z-sorted array
+     * @param _entry is the entry to insert
+     */
+    static void place(Entries & _entries, const Entry & _entry);
 
     /**
-     * Return a pointer to the tag-related list
-     * @param _tag is the tagged list
-     * @return the list
+     * Merge a sorted batch of entries into a z-sorted array (in place, from the end)
+     * @param _entries is the z-sorted array
+     * @param _begin is the first entry of the sorted batch
+     * @param _end is the end of the sorted batch
      */
-    std::list<Object*>* getTagObjects(const std::string & _tag);
+    static void merge(Entries & _entries, Entries::const_iterator _begin, Entries::const_iterator _end);
+
+    /**
+     * Find an object in a z-sorted array (binary search of its crowd handle)
+     * @param _entries is the z-sorted array
+     * @param _object is the object to find
+     * @return the index of the object (-1 if not found)
+     */
+    static int find(const Entries & _entries, Object * _object);
+
+    /**
+     * Give a new crowd handle (z-index and insertion order) to an object
+     * @param _object is the object
+     * @return the entry of the object for the z-sorted arrays
+     */
+    Entry handle(Object * _object);
+
+    /**
+     * Remove an object from a z-sorted array (or leave a hole during a traversal)
+     * @param _entries is the z-sorted array
+     * @param _object is the object to remove
+     * @return true if the object has been found
+     */
+    bool remove(Entries & _entries, Object * _object);
+
+    /**
+     * Remove the holes left in a z-sorted array by the traversals
+     * @param _entries is the z-sorted array
+     */
+    static void compact(Entries & _entries);
+
+    /**
+     * Leave a hole in a z-sorted array for each object which is not in the library anymore
+     * @param _entries is the z-sorted array
+     */
+    void sweep(Entries & _entries);
+
+    /**
+     * Place an object in the z-sorted arrays (or in the pending objects during a traversal)
+     * @param _object is the object to place
+     */
+    void place(Object * _object);
+
+    /**
+     * Remove an object from the z-sorted arrays (and from the pending objects)
+     * @param _object is the object to remove
+     */
+    void remove(Object * _object);
+
+    /**
+     * Place a batch of objects in the z-sorted arrays (or in the pending objects during a traversal)
+     * @param _batch is the batch, sorted by this method
+     */
+    void place(Entries & _batch);
+
+    /**
+     * Insert an active object into the crowd
+     * @param _timestamp is the insertion timestamp
+     * @param _object is the object
+     * @param _batch is the bulk insertion batch (0 for placing the object now)
+     * @return true if the object has been inserted
+     */
+    bool insertObject(int _timestamp, splashouille::Object * _object, Entries * _batch);
+
+    /**
+     * Apply the changes made during the traversals: fill the holes and place the pending objects
+     */
+    void flush();
+
+    /**
+     * Schedule the update of a sleeping object (the previous wake-ups of the object are cancelled)
+     * @param _object is the object
+     * @param _timestamp is the wake-up timestamp
+     */
+    void schedule(Object * _object, int _timestamp);
+
+    /**
+     * Check if a wake-up is still valid: the object is still in the crowd with the same handle and the
+     * wake-up has not been cancelled
+     * @param _wake is the wake-up
+     * @return true if the object has to be updated
+     */
+    bool isScheduled(const Wake & _wake) const;
+
+    /**
+     * Remove the cancelled wake-ups from the queue
+     */
+    void purge();
+
+    /**
+     * Evaluate a due sleeping object (it only changes the object: safe on any thread)
+     * @param _sleeper is the object, filled with the result
+     * @param _timestamp is the current timestamp
+     */
+    static void evaluate(Sleeper & _sleeper, int _timestamp);
+
+    /**
+     * Evaluate a range of due sleeping objects: their styles are blended as one batch (safe on any thread)
+     * @param _sleepers are the objects, filled with the results
+     * @param _begin is the first object of the range
+     * @param _end is the end of the range
+     * @param _timestamp is the current timestamp
+     */
+    static void evaluate(Sleepers & _sleepers, int _begin, int _end, int _timestamp);
+
+    /**
+     * Damage the areas of an evaluated object and schedule its next update
+     * @param _sleeper is the evaluated object
+     * @param _timestamp is the current timestamp
+     */
+    void settle(const Sleeper & _sleeper, int _timestamp);
 
     /**
      * Remove an object from the crowd (do not delete the instance)
      * @param _it is the map iterator
      * @return the instance pointer (0 if deleted failed)
      */
-    splashouille::Object * dropObject(std::map<std::string, Object *>::iterator _it);
+    splashouille::Object * dropObject(ObjectMap::iterator _it);
 
     /** Constructor and destructors */
     Crowd(Animation * _animation);
@@ -72,6 +324,14 @@ public:
      */
     bool insertObject(int _timestamp, splashouille::Object * _object);
 
+    /**
+     * Insert a batch of active objects into the crowd (cheaper than one by one for large batches)
+     * @param _timestamp is the insertion timestamp
+     * @param _objects is the objects list
+     * @return the number of inserted objects
+     */
+    int insertObjects(int _timestamp, const std::vector<splashouille::Object*> & _objects);
+
     /**
      * Get an object from its id
      * @param _id is the object to get
@@ -86,6 +346,13 @@ public:
      */
     splashouille::Object * dropObject(const std::string & _id);
 
+    /**
+     * Remove an object from the crowd (do not delete the instance)
+     * @param _idSymbol is the object to delete as id symbol
+     * @return the instance pointer (0 if deleted failed)
+     */
+    splashouille::Object * dropObjectBySymbol(int _idSymbol);
+
     /**
      * Remove an object from the crowd (do not delete the instance)
      * @param _obj is the object to delete as pointer
@@ -109,6 +376,25 @@ public:
     */
     bool setZIndex(const std::string & _id, int _zIndex);
 
+    /**
+     * Schedule an object of the crowd for the next update
+     * @param _object is the object
+     */
+    void wake(Object * _object);
+
+    /**
+     * Get the next timestamp the crowd changes at: its first wake-up or the next change of its animations
+     * and maps (a cancelled wake-up is counted too: the timestamp may be early but never late)
+     * @return the timestamp (Fashion::never if nothing changes by itself)
+     */
+    int getWakeTimestamp() const;
+
+    /**
+     * Remove a deleted object from the crowd (no callback)
+     * @param _object is the object
+     */
+    void forget(Object * _object);
+
     /**
      * Get the crowd size
      * @return the crowd size as int
@@ -147,6 +433,15 @@ public:
      */
     void forEach(Listener * _listener, const std::string & _tag = "", bool _ascendant = true, int _user = 0) const;
 
+    /**
+     * Parse the crowd
+     * @param _listener is the callback listener
+     * @param _tagSymbol is the requested tag object as symbol (all objects if Symbol::empty)
+     * @param _ascendant is true for an z-index ascendant browsing (from farest to closest)
+     * @param _user is a user parameter forwarded to the callback
+     */
+    void forEach(Listener * _listener, int _tagSymbol, bool _ascendant = true, int _user = 0) const;
+
     /**
      * Update the current crowd
      * @param _timestamp is the current timestamp
@@ -155,7 +450,23 @@ public:
     void update(int _timestamp);
 
     /**
-     * Render the current crowd
+     * Prepare the next render: browse the crowd from the front to the back and mark the objects
+     * fully covered by an opaque object above them
+     * @param _surface is the surface to render
+     * @param _offset is the parent offset
+     */
+    void occlude(SDL_Surface * _surface, SDL_Rect * _offset = 0);
+
+    /**
+     * Check if an area will be fully covered by an opaque object during the next render
+     * @param _rect is the area in the surface coordinates
+     * @return true if the area is covered
+     */
+    bool isOccluded(const SDL_Rect * _rect) const;
+
+    /**
+     * Render the current crowd: each object is rendered only in the update rects of the surface owner it
+     * intersects, clipped to these rects
      * @param _surface is the surface to render
      * @param _offset is the parent offset
      */
@@ -175,6 +486,13 @@ public:
      */
     void changeFashion(const std::string & _fashionId, const std::string & _tag = "");
 
+    /**
+     * Change the current fashion
+     * @param _fashionSymbol is the fashion Id as symbol
+     * @param _tagSymbol is the requested tag object as symbol (all objects if Symbol::empty)
+     */
+    void changeFashion(int _fashionSymbol, int _tagSymbol);
+
     /**
      * Forward the callback
      * @return true
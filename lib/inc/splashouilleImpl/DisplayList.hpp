@@ -0,0 +1,150 @@
+/*
+Copyright 2011 JohannC
+
+This file is part of SPLASHOUILLE.
+
+SPLASHOUILLE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+SPLASHOUILLE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+SPLASHOUILLE.  If not, see http://www.gnu.org/licenses/
+*/
+
+#ifndef SPLASHOUILLEIMPL_DISPLAYLIST_HPP_
+#define SPLASHOUILLEIMPL_DISPLAYLIST_HPP_
+
+#include <splashouilleImpl/Blitter.hpp>
+#include <SDL.h>
+#include <vector>
+#include <tr1/unordered_map>
+
+namespace splashouilleImpl
+{
+
+/**
+ * The blit commands of a crowd render
+ * The objects are prepared once per frame and give their blit command (one per damaged rect they
+ * intersect), the commands are then executed in order. The array is kept from frame to frame.
+ * The large lists are binned by screen tile (a command is cut by the tiles it covers) and the tiles
+ * are rasterized in parallel: each tile keeps the commands order and the tiles do not overlap, so
+ * the pixels are the same as the serial execution.
+ * The sources are classified for the engine blitter when the objects are prepared, the others are
+ * blitted by SDL.
+ */
+class DisplayList
+{
+public:
+    /**
+     * A blit command
+     */
+    class Command
+    {
+    public:
+        SDL_Surface *                       surface;                    // The source surface
+        SDL_Rect                            source;                     // The source rect
+        SDL_Rect                            position;                   // The destination rect
+        SDL_Rect                            clip;                       // The destination clip rect
+        Uint8                               alpha;                      // The surface alpha
+        Blitter::Mode                       mode;                       // The blit path of the source
+    };
+
+private:
+    /**
+     * The counters of a tile rasterization (summed in the profiling counters after the stage)
+     */
+    class Bin
+    {
+    public:
+        int                                 first;                      // The first command of the tile in the binned list
+        long                                nbBlits;                    // The number of blits of the tile
+        long                                nbBlittedPixels;            // The number of blitted pixels of the tile
+    };
+    class Raster;
+
+    std::vector<Command>                    commands;                   // The commands (kept between the frames)
+    int                                     nbCommands;                 // The number of commands of the current frame
+    std::vector<Bin>                        bins;                       // The screen tiles (one more for the end)
+    std::vector<int>                        binned;                     // The commands index sorted by tile
+    std::tr1::unordered_map<SDL_Surface*, Uint8> alphas;                // The alpha of each source of the list
+
+    const static int                        binSize         = 128;      // The screen tiles width and height in pixels
+    const static int                        nbCommandsMin   = 64;       // Below, the list is executed by the calling thread
+
+    /**
+     * Check if a command is executed by the engine blitter
+     * @param _surface is the destination surface
+     * @param _command is the blit command
+     * @return true if the engine blitter is used, false for SDL
+     */
+    static bool isBlitted(const SDL_Surface * _surface, const Command & _command)
+    {
+        return (_command.mode!=Blitter::sdl && Blitter::accepts(_command.surface, _surface));
+    }
+
+    /**
+     * Prepare the parallel execution: the sources blitted by SDL must keep one alpha during the list and
+     * be mapped on the destination (SDL changes the source surface when its alpha or its destination changes)
+     * @param _surface is the destination surface
+     * @return true if the tiles can be rasterized by several threads
+     */
+    bool prepare(SDL_Surface * _surface);
+
+    /**
+     * Cut the blit rects by a clip rect, with the same steps as SDL_UpperBlit
+     * @param _source is the source surface
+     * @param _clip is the clip rect
+     * @param _sourceRect is the source rect (updated)
+     * @param _position is the destination rect (updated)
+     * @return true if the blit is not empty
+     */
+    static bool clip(const SDL_Surface * _source, const SDL_Rect * _clip, SDL_Rect * _sourceRect, SDL_Rect * _position);
+
+    DisplayList(const DisplayList &);
+    DisplayList & operator=(const DisplayList &);
+
+public:
+    DisplayList():nbCommands(0) {}
+
+    /**
+     * Add a command
+     * @param _command is the blit command
+     * @param _clip is the destination clip rect
+     */
+    void push(const Command & _command, const SDL_Rect * _clip);
+
+    /**
+     * Execute the commands in order then clear the list
+     * @param _surface is the destination surface
+     */
+    void execute(SDL_Surface * _surface);
+
+    /** Accessors */
+    int                                     getNumberOfCommands() const { return nbCommands; }
+
+    /**
+     * Execute one command
+     * @param _surface is the destination surface
+     * @param _command is the blit command
+     */
+    static void blit(SDL_Surface * _surface, const Command & _command);
+
+    /**
+     * Get the blit rects of an object regarding its parent offset: the object is moved by the offset
+     * and cut by its top left corner. The source is classified for the blitter
+     * @param _position is the object position
+     * @param _source is the object source
+     * @param _offset is the parent offset (if any)
+     * @param _command is the blit command (input: surface and alpha, output: source, position and mode)
+     * @return true if the blit is not empty
+     */
+    static bool place(const SDL_Rect * _position, const SDL_Rect * _source, const SDL_Rect * _offset, Command * _command);
+};
+
+}
+
+#endif
@@ -0,0 +1,79 @@
+/*
+Copyright 2011 JohannC
+
+This file is part of SPLASHOUILLE.
+
+SPLASHOUILLE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+SPLASHOUILLE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+SPLASHOUILLE.  If not, see http://www.gnu.org/licenses/
+*/
+
+#ifndef SPLASHOUILLEIMPL_EASING_HPP_
+#define SPLASHOUILLEIMPL_EASING_HPP_
+
+namespace splashouilleImpl
+{
+
+/**
+ * The global table of the easing curves
+ * A curve is sampled once in a lookup table shared by all the transitions with the same speeds,
+ * the ratio is then interpolated between two samples. The curves are never removed from the table.
+ * The table is locked: the transitions are built by the threaded import as well as by the main thread.
+ */
+class Easing
+{
+public:
+    const static int                        nbSamples       = 256;      // The number of intervals of a curve
+
+    /**
+     * Get the curve f(t)=at3+bt2+ct with f(0)=0, f(1)=1, f'(0)=_speedIn and f'(1)=_speedOut
+     * (the curve is sampled if it is unknown)
+     * @param _speedIn is the speed at the begin of the transition
+     * @param _speedOut is the speed at the end of the transition
+     * @return the curve id
+     */
+    static int get(double _speedIn, double _speedOut);
+
+    /**
+     * Get the samples of a curve
+     * @param _curve is the curve id
+     * @return the nbSamples+1 samples (valid until the end of the program)
+     */
+    static const float * getSamples(int _curve);
+
+    /**
+     * Get the ratio of a curve (the interpolation index is computed with integers)
+     * @param _samples is the curve samples
+     * @param _elapsed is the time elapsed since the beginning of the transition
+     * @param _duration is the duration of the transition
+     * @return the ratio
+     */
+    static float ratio(const float * _samples, int _elapsed, int _duration);
+
+    /**
+     * Get the ratios of a batch of transitions (same results as ratio on each transition)
+     * @param _samples are the curves samples
+     * @param _elapsed are the times elapsed since the beginning of the transitions
+     * @param _durations are the durations of the transitions
+     * @param _ratios are the ratios (output)
+     * @param _size is the number of transitions
+     */
+    static void ratios(const float * const * _samples, const int * _elapsed, const int * _durations, float * _ratios, int _size);
+
+    /**
+     * Get the number of curves
+     * @return the size of the table
+     */
+    static int getSize();
+};
+
+}
+
+#endif
@@ -20,6 +20,7 @@ SPLASHOUILLE.  If not, see http://www.gnu.org/licenses/
 
 #include <splashouille/Engine.hpp>
 #include <splashouilleImpl/Animation.hpp>
+#include <splashouilleImpl/ThreadPool.hpp>
 #include <list>
 
 namespace splashouilleImpl
@@ -34,6 +35,34 @@ public:
     static mouseModeEnum                mouseMode;      // The mouse mode
     static std::string                  locale;         // The locale value ["fr", "en"]
     static bool                         debug;          // Debug mode
+    static long                         nbBlits;        // The number of blits (profiling)
+    static long                         nbBlittedPixels;// The number of blitted pixels (profiling)
+
+    /**
+     * Blit a surface with SDL and count the blitted pixels
+     * @param _src is the source surface
+     * @param _srcRect is the source rectangle (0 for the whole surface)
+     * @param _dst is the destination surface
+     * @param _dstRect is the destination rectangle, updated with the final blitted area
+     * @return the SDL_BlitSurface result
+     */
+    static int blit(SDL_Surface * _src, SDL_Rect * _srcRect, SDL_Surface * _dst, SDL_Rect * _dstRect)
+    {
+        int ret = SDL_BlitSurface(_src, _srcRect, _dst, _dstRect);
+        if (!ret) { count(_dstRect?_dstRect->w*_dstRect->h:_src->w*_src->h); }
+        return ret;
+    }
+
+    /**
+     * Count a blit (the offscreen surfaces may be rendered in parallel)
+     * @param _nbPixels is the number of blitted pixels
+     */
+    static void count(long _nbPixels)
+    {
+        ThreadPool::Guard guard;
+        nbBlits++;
+        nbBlittedPixels += _nbPixels;
+    }
 
 private:
     Library *                           library;        // The general library
@@ -42,9 +71,22 @@ private:
     SDL_Surface *                       background;     // The background surface
     int                                 fps;            // The framerate per second
     bool                                onPause;        // Is the engine on pause
+    bool                                looping;        // Is the event loop of run going on (stop and pause wake it up)
     Uint32                              begin;          // The animation begin timestamp
     Uint32                              now;            // The now animation
     int                                 progress;       // The progress value used during the threaded import
+    splashouille::Engine::Clock *       clock;          // The optional clock (SDL timer if null)
+    int                                 frameSec;       // The number of frames played during the current second
+    unsigned int                        lastSecond;     // The current second
+
+    const static int                    nbProfileSamplesMax = 256;
+    float                               profileSamples[splashouille::Engine::Profile::last][nbProfileSamplesMax];
+                                                        // The ring buffer of the last frames phases durations
+    int                                 profileIndex;   // The next sample index in the ring buffer
+    int                                 nbProfileSamples;   // The number of samples in the ring buffer
+    double                              phases[splashouille::Engine::Profile::last];
+                                                        // The phases durations of the current frame
+    splashouille::Engine::Profile       profile;        // The last computed profile summary
 
     class ListenerElement {
     public:
@@ -60,6 +102,57 @@ private:
     */
     void flip(SDL_Surface * _surface);
 
+    /**
+     * Choose between a full update and the update rects
+     * @param _surface is the screen surface
+     * @return true if the full update is cheaper
+     */
+    bool isFullUpdate(SDL_Surface * _surface);
+
+    /**
+     * Get the current time from the clock with a sub-millisecond precision
+     * @return the current time in milliseconds
+     */
+    double getTime();
+
+    /**
+     * Get the current time from the clock
+     * @return the current time in milliseconds
+     */
+    Uint32 getTicks() { return static_cast<Uint32>(getTime()); }
+
+    /**
+     * Sleep until a deadline (the thread is suspended, no busy wait)
+     * @param _deadline is the wake up time in milliseconds (same origin as getTime)
+     */
+    void sleepUntil(double _deadline);
+
+    /**
+     * Wake the event loop up (it may be waiting for an event while stop or pause is called from another thread)
+     */
+    void wakeUp();
+
+    /**
+     * Store the phases durations of the current frame in the ring buffer
+     */
+    void recordProfile();
+
+    /**
+     * Prepare the engine before running the animation
+     * @param _surface is the SDL surface for rendering the animation
+     * @param _bg for handling the background
+     * @param _display is false if the surface is not the video surface
+     */
+    void start(SDL_Surface * _surface, splashouille::Animation::backgroundEnum _bg, bool _display);
+
+    /**
+     * Process one frame: listeners, update and render
+     * @param _surface is the SDL surface for rendering the animation
+     * @param _display is false if the surface is not the video surface (no flip)
+     * @param _update is false if nothing is due in the scene (only the listeners are called)
+     */
+    void process(SDL_Surface * _surface, bool _display, bool _update = true);
+
 public:
     Engine(Library * _library);
     ~Engine();
@@ -128,12 +221,12 @@ public:
     bool deleteListener(splashouille::Engine::Listener * _listener);
 
     /**
-     * Stop the engine
+     * Stop the engine (an SDL_USEREVENT wakes the run loop up, so it may be called from another thread)
      */
     void stop();
 
     /**
-     * Pause/Play the engine
+     * Pause/Play the engine (an SDL_USEREVENT wakes the run loop up, so it may be called from another thread)
      */
     void pause();
 
@@ -143,6 +236,18 @@ public:
      */
     void setFPS(int _fps) { fps = _fps; }
 
+    /**
+     * Set the clock used by the run method
+     * @param _clock is the new clock (0 for the SDL timer)
+     */
+    void setClock(splashouille::Engine::Clock * _clock) { clock = _clock; }
+
+    /**
+     * Get the duration summary of the last frames phases
+     * @return the frame profile
+     */
+    const splashouille::Engine::Profile * getProfile();
+
     /**
      * Run the animation
      * @param _surface is the SDL surface for rendering the animation
@@ -151,6 +256,18 @@ public:
      */
     bool run(SDL_Surface * _surface, splashouille::Animation::backgroundEnum _bg = splashouille::Animation::copy);
 
+    /**
+     * Run the animation without display
+     * @param _surface is the offscreen SDL surface for rendering the animation
+     * @param _nbFrames is the number of frames to render (-1 for no limit)
+     * @param _stepInMilliSeconds is the virtual time between two frames (0 needs a number of frames)
+     * @param _timeStampMax is the last timestamp to render (-1 for no limit)
+     * @param _bg for handling the background
+     * @return true if everything is fine
+     */
+    bool runHeadless(SDL_Surface * _surface, int _nbFrames, int _stepInMilliSeconds, int _timeStampMax = -1,
+                     splashouille::Animation::backgroundEnum _bg = splashouille::Animation::copy);
+
     /**
      * Log the engine to the standard output
      * @param _rank is the log rank
@@ -35,6 +35,9 @@ namespace splashouilleImpl
 {
 
 class Timeline;
+class Library;
+class Object;
+class Animation;
 
 /**
  * The event implementation class.
@@ -49,11 +52,16 @@ private:
     int                         timeStampInMilliSeconds;        // Trigger of the event
     Type                        type;                           // Type of the event
     splashouille::Object *      object;                         // An optional object pointer
-    std::vector<std::string>    objectIds;                      // An optional object ids vector
+    std::vector<int>            objectSymbols;                  // An optional object ids (or tags) vector as symbols
+    std::vector<Object *>       targets;                        // The objects of the ids (bound on the first run)
+    Animation *                 targetAnimation;                // The animation of the timeline change (bound on the first run)
+    unsigned int                revision;                       // The library revision of the bound objects
+    bool                        bound;                          // Are the objects bound
     std::string                 id;                             // The event id
     Timeline *                  timeline;                       // The parent timeline
     unsigned int                value;                          // A generic integer value
     std::string                 valueStr;                       // A generic string value
+    int                         valueSymbol;                    // The generic string value as symbol
     bool                        option;                         // A generic boolean value
 
     Event(Timeline * _timeline);
@@ -74,6 +82,12 @@ private:
      */
     bool import(splashouille::Library * _library, libconfig::Setting & _setting);
 
+    /**
+     * Bind the object ids to the library objects (again if objects have been inserted or deleted since)
+     * @param _library is the objects library
+     */
+    void bind(Library * _library);
+
     /**
      * Clear the event
      */
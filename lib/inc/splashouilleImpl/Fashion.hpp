@@ -19,15 +19,12 @@ SPLASHOUILLE.  If not, see http://www.gnu.org/licenses/
 #define SPLASHOUILLEIMPL_FASHION_HPP_
 
 #include <splashouille/Fashion.hpp>
-#include <list>
-
-namespace splashouille
-{
-class Style;
-}
+#include <splashouilleImpl/Style.hpp>
+#include <vector>
 
 namespace splashouilleImpl
 {
+class Object;
 
 /**
  * The class which makes the style update.
@@ -42,7 +39,7 @@ private:
     class Transition
     {
     private:
-        double                      a, b, c;                        // The ratio function f(t)=at3+bt2+ct
+        const float *               curve;                          // The shared samples of the ratio function
     public:
         /**
          * Transition constructor
@@ -71,8 +68,28 @@ private:
          */
         float ratio(int _timestamp);
 
+        /**
+         * Get the progress of the transition regarding the timestamp (the Easing::ratio parameters)
+         * @param _timestamp is the current timestamp
+         * @param _elapsed is the time elapsed since the beginning of the transition (output)
+         * @param _duration is the duration of the transition (output)
+         */
+        void span(int _timestamp, int & _elapsed, int & _duration) const;
+
+        /**
+         * Get the curve of the transition
+         * @return the curve samples
+         */
+        const float * getCurve() const { return curve; }
+
+        /**
+         * Get the first timestamp the transition has to be handled at
+         * @return the smallest timestamp of the transition
+         */
+        int start() const { return timestampIn<timestampOut?timestampIn:timestampOut; }
+
         /** Attributes */
-        splashouille::Style *       style;                          // The next style
+        Style *                     style;                          // The next style
         int                         timestampIn;                    // The timestamp in
         int                         timestampOut;                   // The timestamp out
         double                      speedIn;                        // The speed in
@@ -80,21 +97,106 @@ private:
         int                         period;                         // The transition period
         int                         nbTimes;                        // The number of period revolutions
         bool                        done;                           // The transition is done
+        unsigned int                order;                          // The insertion order in the fashion
+    };
+    typedef std::vector<Transition*>    Transitions;
+
+    /**
+     * A key of a property track: the end of a transition which sets the property
+     */
+    class Key
+    {
+    public:
+        int                         timestamp;                      // The timestamp out of the transition
+        Transition *                transition;                     // The transition
+        Key(int _timestamp, Transition * _transition):timestamp(_timestamp), transition(_transition) {}
     };
+    typedef std::vector<Key>            Track;
 
 private:
-    splashouille::Style *       last;                               // The last current style
-    splashouille::Style *       current;                            // The current style
-    splashouille::Style *       style;                              // The initial style
-    std::list<Transition*>      transitions;                        // A list of transition
+    Style *                     last;                               // The last current style
+    Style *                     current;                            // The current style
+    Style *                     style;                              // The initial style
+    Transitions                 transitions;                        // The transitions sorted by start timestamp
+    Transitions                 running;                            // The started transitions sorted by insertion
+    Transitions                 active;                             // The running transitions in progress (getStyle)
+    unsigned int                next;                               // The first transition not started yet
+    unsigned int                order;                              // The next insertion order
     int                         timestamp;                          // The last timestamp when current has been computed
+    Track                       tracks[splashouille::Style::__last];// The keys of each property (not periodic transitions)
+    Transitions                 periodic;                           // The periodic transitions
+    int                         duration;                           // The longest not periodic transition
+    bool                        compiled;                           // Are the tracks up to date with the transitions
+    bool                        seeking;                            // Has the next timestamp to be sampled from the tracks
+    Object *                    owner;                              // The object woken up by the changes (0 if none)
+
+    /**
+     * Compare two transitions regarding their start timestamp
+     * @param _a is the first transition
+     * @param _b is the second transition
+     * @return true if _a starts before _b
+     */
+    static bool startsBefore(const Transition * _a, const Transition * _b) { return _a->start()<_b->start(); }
+
+    /**
+     * Compare two transitions regarding their insertion order
+     * @param _a is the first transition
+     * @param _b is the second transition
+     * @return true if _a has been inserted before _b
+     */
+    static bool insertedBefore(const Transition * _a, const Transition * _b) { return _a->order<_b->order; }
+
+    /**
+     * Compare two keys regarding their timestamp then the transitions insertion order
+     * @param _a is the first key
+     * @param _b is the second key
+     * @return true if _a is before _b
+     */
+    static bool keyBefore(const Key & _a, const Key & _b)
+    {
+        return (_a.timestamp<_b.timestamp) || (_a.timestamp==_b.timestamp && _a.transition->order<_b.transition->order);
+    }
+
+    /**
+     * Compare a timestamp with a key (binary search in a track)
+     * @param _timestamp is the timestamp
+     * @param _key is the key
+     * @return true if the key is after the timestamp
+     */
+    static bool keyAfter(int _timestamp, const Key & _key) { return _timestamp<_key.timestamp; }
+
+    /**
+     * Compare a timestamp with the start of a transition (binary search in the transitions)
+     * @param _timestamp is the timestamp
+     * @param _transition is the transition
+     * @return true if the transition starts after the timestamp
+     */
+    static bool startsAfter(int _timestamp, const Transition * _transition) { return _timestamp<_transition->start(); }
+
+    /**
+     * Build the property tracks from the transitions
+     */
+    void compile();
+
+    /**
+     * Set the transitions state and the initial style at any timestamp without replaying the previous
+     * timestamps: the last finished transition of each property is found in its track (binary search)
+     * @param _timestamp is the current timestamp
+     */
+    void seek(int _timestamp);
+
+    /**
+     * Start a transition (keep the running transitions sorted by insertion)
+     * @param _transition is the transition
+     */
+    void run(Transition * _transition);
 
     /**
      * Remove the old transitions (regarding the current timestamp) by updating the initial style
+     * Only the started transitions are visited, the transitions in progress are stored in active
      * @param _timestamp is the current timestamp
-     * @param _active is set to true if a transaction is currently active
      */
-    void removeOldTransitions(int _timestamp, bool & _active);
+    void removeOldTransitions(int _timestamp);
 
     /**
      * Add an animation to the current style
@@ -104,6 +206,39 @@ private:
     splashouille::Style * addTransition(Transition * _transition);
 
 public:
+    const static int            never           = 0x7fffffff;       // The wake-up timestamp of a fashion which does not change
+
+    /**
+     * The blend of the current styles of several fashions: the ratios and the mixes of all their active
+     * transitions are computed in structure-of-arrays buffers
+     */
+    class Batch
+    {
+    private:
+        std::vector<Fashion*>               fashions;               // The fashions to blend
+        Transitions                         steps;                  // The active transitions of the fashions
+        std::vector<const float*>           curves;                 // The curve of each active transition
+        std::vector<int>                    elapsed;                // The elapsed time of each active transition
+        std::vector<int>                    durations;              // The duration of each active transition
+        std::vector<float>                  ratios;                 // The ratio of each active transition
+        std::vector<unsigned int>           first;                  // The first active transition of each fashion (and the end)
+        std::vector<Style*>                 styles;                 // The styles of a round of mixes
+        std::vector<const Style*>           targets;                // The styles to mix of a round
+        std::vector<float>                  mixRatios;              // The ratios of a round
+        Style::Lanes                        lanes;                  // The lanes of a round
+    public:
+        /**
+         * Add a fashion to blend
+         * @param _fashion is the fashion (prepared with a true result)
+         */
+        void add(Fashion * _fashion) { fashions.push_back(_fashion); }
+
+        /**
+         * Blend the fashions added since the last run (same result as Fashion::blend on each of them)
+         */
+        void run();
+    };
+
     Fashion(splashouille::Fashion * _fashion);
     Fashion();
 
@@ -112,6 +247,12 @@ public:
      */
     ~Fashion();
 
+    /**
+     * Set the object woken up by the changes of the fashion, of its initial style and of its transitions styles
+     * @param _owner is the object
+     */
+    void setOwner(Object * _owner);
+
     /**
      * Import a fashion
      * @param _fashion is the parent fashion
@@ -153,25 +294,51 @@ public:
      * @param _timestamp is the current timestamp
      * @return the current style
      */
-    splashouille::Style * getStyle(int timestamp);
+    Style * getStyle(int timestamp);
+
+    /**
+     * Prepare the computation of the current style: seek the transitions and remove the old ones
+     * @param _timestamp is the current timestamp
+     * @return true if the last style has to be blended with the active transitions (then committed)
+     */
+    bool prepare(int _timestamp);
+
+    /**
+     * Blend the active transitions into the last style one by one (see Batch for several fashions)
+     */
+    void blend();
+
+    /**
+     * Commit the last style into the current style
+     * @param _blended is true if the last style has been blended (see prepare)
+     * @return the current style
+     */
+    Style * commit(bool _blended);
+
+    /**
+     * Get the next timestamp the style changes at: the next transition start or boundary
+     * (to call after getStyle, the style does not change before)
+     * @return the timestamp (never if the style does not change anymore)
+     */
+    int getWakeTimestamp() const;
 
     /**
      * Get the current style
      * @return the current style but const (because automaticaly generated)
      */
-    const splashouille::Style * getCurrent() { return current; }
+    const Style * getCurrent() { return current; }
 
     /**
      * Get the initial style
      * @return the initial style
      */
-    splashouille::Style * getStyle() { return style; }
+    Style * getStyle() { return style; }
 
     /**
      * Get the list of transitions
-     * @return the list of transition as cont
+     * @return the list of transition (sorted by start timestamp) as const
      */
-    const std::list<Transition*> &  getTransitions() { return transitions; }
+    const Transitions &             getTransitions() { return transitions; }
 
     /**
      * Clear the transition regarding the new timestamp
@@ -19,18 +19,22 @@ SPLASHOUILLE.  If not, see http://www.gnu.org/licenses/
 #define SPLASHOUILLEIMPL_LIBRARY_HPP_
 
 #include <splashouille/Library.hpp>
+#include <splashouilleImpl/Symbol.hpp>
 
-#include <map>
 #include <string>
 
 namespace splashouilleImpl
 {
+class Object;
 
 class Library : public splashouille::Library
 {
 private:
-    std::map<std::string, splashouille::Object *>   library;
+    typedef std::tr1::unordered_map<int, Object *>  ObjectMap;
+
+    ObjectMap                                       library;        // The objects by id symbol
     splashouille::Library::Listener *               listener;
+    unsigned int                                    revision;       // Changed each time an object is inserted or deleted
 
     static int                                      nbObjects;
 
@@ -40,7 +44,7 @@ private:
      * @param _erase the iterator from the map
      * @return true if success
      */
-    bool deleteObject(const std::map<std::string, splashouille::Object *>::iterator & _it, bool _erase = true);
+    bool deleteObject(const ObjectMap::iterator & _it, bool _erase = true);
 
 public:
     Library();
@@ -52,7 +56,7 @@ public:
      * @param _object is the object to insert
      * @return true if succeed
      */
-    bool insertObject(const std::string & _key, splashouille::Object * _object);
+    bool insertObject(const std::string & _key, Object * _object);
 
     /**
      * Import and prepare the library
@@ -100,14 +104,16 @@ public:
 
     /** Some accessors */
     int                                     getSize() const { return library.size(); }
+    unsigned int                            getRevision() const { return revision; }
     splashouille::Solid *                   getSolidById(const std::string & _id) const;
     splashouille::Image *                   getImageById(const std::string & _id) const;
     splashouille::Animation *               getAnimationById(const std::string & _id) const;
     splashouille::Sound *                   getSoundById(const std::string & _id) const;
     splashouille::Map *                     getMapById(const std::string & _id) const;
-    splashouille::Object *                  getObjectById(const std::string& _id) const
+    splashouille::Object *                  getObjectById(const std::string& _id) const;
+    Object *                                getObjectBySymbol(int _symbol) const
     {
-        std::map<std::string, splashouille::Object *>::const_iterator it = library.find(_id);
+        ObjectMap::const_iterator it = library.find(_symbol);
         return (it!=library.end())?it->second:0;
     }
 
@@ -56,6 +56,7 @@ private:
     splashouille::Library *                 library;    // The root library for creating tiles in a dynamic way
     splashouille::Image *                   tileset;    // The tileset object reference
     std::list<splashouille::Object*>        toDelete;   // The tiles to delete list (can not delete objects from onObject callback)
+    std::vector<splashouille::Object*>      toInsert;   // The new tiles list (inserted at once)
     int                                     size[4];    // The size of the map
     int *                                   map;        // The map array
     Mode                                    mode;       // The map mode (ortho or iso)
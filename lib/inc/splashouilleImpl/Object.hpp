@@ -19,13 +19,19 @@ SPLASHOUILLE.  If not, see http://www.gnu.org/licenses/
 #define SPLASHOUILLEIMPL_OBJECT_HPP_
 
 #include <splashouille/Object.hpp>
+#include <splashouilleImpl/Symbol.hpp>
+#include <splashouilleImpl/DisplayList.hpp>
 #include <string>
-#include <map>
 
 namespace splashouilleImpl
 {
 class Fashion;
 class Crowd;
+class Solid;
+class Image;
+class Animation;
+class Sound;
+class Map;
 
 /**
  * The object implementation class.
@@ -42,29 +48,61 @@ private:
 
 protected:
     inline int                                  min(int nX, int nY) { return nX > nY ? nY : nX; }
-    typedef std::map<std::string, Fashion*>     FashionMap;
+    typedef std::tr1::unordered_map<int, Fashion*> FashionMap;
 
     Object(const std::string & _id);
     ~Object();
 
+    /**
+     * Set the concrete kind of the object (to call by the constructors of the derived classes)
+     * @param _object is the object as its concrete class
+     */
+    void setKind(Solid * _object)               { kind = kindSolid;     concrete.solid = _object; }
+    void setKind(Image * _object)               { kind = kindImage;     concrete.image = _object; }
+    void setKind(Animation * _object)           { kind = kindAnimation; concrete.animation = _object; }
+    void setKind(Sound * _object)               { kind = kindSound;     concrete.sound = _object; }
+    void setKind(Map * _object)                 { kind = kindMap;       concrete.map = _object; }
+
 public:
+    /**
+     * The concrete kinds of object: the hot paths dispatch on the kind instead of calling
+     * virtual methods or casting the object
+     */
+    enum Kind { kindObject, kindSolid, kindImage, kindAnimation, kindSound, kindMap };
     static int                              garbageNumber;          // Number of allocated objects
+    static const int                        symbolDefault;          // The symbol of the default fashion and tag
+
+    Kind                                    kind;                   // The concrete kind of the object
+    union
+    {
+        Solid *                             solid;
+        Image *                             image;
+        Animation *                         animation;
+        Sound *                             sound;
+        Map *                               map;
+    }                                       concrete;               // The object as its concrete class (regarding kind)
 
     FashionMap                              fashions;               // The fashions of the object
     Fashion *                               fashion;                // The current fashion
     SDL_Surface *                           surface;                // The render surface
     SDL_Rect *                              source;                 // The source image
     SDL_Rect *                              position;               // The position
-    SDL_Rect *                              updateArea;             // The update area
+    SDL_Rect *                              updateArea;             // The position before the last change
     std::string                             id;                     // The object id
     std::string                             type;                   // The object type
-    std::string                             fashionId;              // The current fashion id
-    std::string                             tag;                    // The object tag
+    int                                     idSymbol;               // The object id as symbol
+    int                                     fashionSymbol;          // The current fashion id as symbol
+    int                                     tagSymbol;              // The object tag as symbol
     int                                     initialTimestamp;       // The initial timestamp of the object
     int                                     zIndex;                 // The object z-index;
     int                                     state;                  // The callback state parameter
     unsigned long                           nbUpdates;              // The number of updates of the object
     bool                                    mouseOver;              // Is the mouse over the object
+    int                                     crowdZIndex;            // The z-index of the object in the crowd arrays
+    unsigned int                            crowdSequence;          // The insertion order of the object in the crowd
+    Crowd *                                 container;              // The crowd which updates the object (0 if none)
+    unsigned int                            wakeStamp;              // The stamp of the last wake-up scheduled in the crowd
+    bool                                    awake;                  // Is the object scheduled for the next crowd update
 
     splashouille::Object::Listener *        listener;               // The object listener
     splashouille::Object::AssociatedData *  associatedData;         // The associated data
@@ -82,6 +120,17 @@ public:
      */
     bool mouseEvent(int _timestampInMilliSeconds, int _x, int _y, bool _checkOver, int _state = 0);
 
+    /**
+     * Schedule the object for the next update of its crowd (its style or its fashion may have been changed)
+     */
+    void wake();
+
+    /**
+     * Get the next timestamp the object changes at (to call after the update)
+     * @return the timestamp (Fashion::never if the object does not change by itself)
+     */
+    int getWakeTimestamp() const;
+
     /**
      * get the object id
      * @return the object id as string
@@ -98,12 +147,12 @@ public:
      * get the object tag
      * @return the tag as string
      */
-    const std::string & getTag() const { return tag; }
+    const std::string & getTag() const { return Symbol::getName(tagSymbol); }
 
     /**
      * set the object tag (to call before inserting in the crowd)
      */
-    void setTag(const std::string & _tag) { tag = _tag; }
+    void setTag(const std::string & _tag) { tagSymbol = Symbol::get(_tag); }
 
     /**
      * get the z-index
@@ -150,7 +199,7 @@ public:
      * Get the current fashion id
      * @return the fashion id as string
      */
-    const std::string & getFashionId() { return fashionId; }
+    const std::string & getFashionId() { return Symbol::getName(fashionSymbol); }
 
     /**
      * Get the style
@@ -166,6 +215,14 @@ public:
      */
     bool changeFashion(const std::string & _fashionId, bool _force = false);
 
+    /**
+     * Change the current fashion
+     * @param _fashionSymbol is the fashion Id as symbol
+     * @param _force is true than change fashion even if it is the same
+     * @return true if the fashion is found
+     */
+    bool changeFashion(int _fashionSymbol, bool _force = false);
+
     /**
      * Clone the fashion of another object
      * @param _object is the fashion source
@@ -198,6 +255,20 @@ public:
      */
     virtual bool update(int _timestamp);
 
+    /**
+     * Start the update of the object: prepare the current style of its fashion
+     * @param _timestamp is the current timestamp
+     * @return true if the style has to be blended (see Fashion::prepare)
+     */
+    bool prepareUpdate(int _timestamp);
+
+    /**
+     * End the update of the object once its style is blended
+     * @param _blended is the result of prepareUpdate
+     * @return true if the object has changed
+     */
+    bool finishUpdate(bool _blended);
+
     /**
      * Render the object into the surface canvas
      * @param _surface is the surface to fill
@@ -206,6 +277,25 @@ public:
      */
     virtual bool render(SDL_Surface * _surface UNUSED, SDL_Rect * _offset UNUSED = 0) { return true; }
 
+    /**
+     * Prepare the render of the object and get its blit command
+     * @param _surface is the surface to fill
+     * @param _offset is the parent offset
+     * @param _command is the blit command (output)
+     * @return true if there is something to blit
+     */
+    virtual bool compile(SDL_Surface * _surface UNUSED, SDL_Rect * _offset UNUSED, DisplayList::Command * _command UNUSED)
+    {
+        return false;
+    }
+
+    /**
+     * Get the area fully covered by the object when it is rendered (used for the occlusion)
+     * @param _rect is the opaque area in the parent coordinates (output)
+     * @return true if the object is opaque on a not empty area
+     */
+    virtual bool getOpaqueRect(SDL_Rect * _rect UNUSED) { return false; }
+
     /**
      * Get the position of the object
      * @param x,y,w,h are the coordinates of the object
@@ -220,8 +310,8 @@ public:
     virtual const SDL_Rect * getPosition() { return position; }
 
     /**
-     * Get the updateArea of the object
-     * @return the position
+     * Get the position of the object before its last change (the area to update with the new position)
+     * @return the previous position
      */
     virtual const SDL_Rect * getUpdateRect() { return updateArea; }
 
@@ -0,0 +1,161 @@
+/*
+Copyright 2011 JohannC
+
+This file is part of SPLASHOUILLE.
+
+SPLASHOUILLE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+SPLASHOUILLE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+SPLASHOUILLE.  If not, see http://www.gnu.org/licenses/
+*/
+
+#ifndef SPLASHOUILLEIMPL_REGION_HPP_
+#define SPLASHOUILLEIMPL_REGION_HPP_
+
+#include <SDL.h>
+#include <vector>
+
+namespace splashouilleImpl
+{
+
+/**
+ * The damaged region of an animation surface
+ * The surface is split into a grid of tiles, each tile stores the bounding box of its damaged
+ * pixels. Adding a rect only touches the tiles it covers and the overlapping rects are merged
+ * inside the tiles, so the pixels are never counted twice.
+ * The update rects arrays are borrowed from a pool shared by all the regions while they are damaged.
+ * Each tile remembers the rect covering it, so the rects under an area are found from its tiles.
+ */
+class Region
+{
+public:
+    const static int                        tileSize        = 32;       // The tile width and height in pixels
+    const static int                        rectCost        = 1024;     // The cost of one update rect (in pixels)
+    const static int                        nbRectsMax      = 4096;     // Beyond, the region is made of tile rows
+    const static int                        nbRectsMin      = 16;       // The smallest array of the pool
+
+private:
+    class Tile
+    {
+    public:
+        Sint16                              x0, y0, x1, y1;             // The damaged box (empty if x1<=x0)
+        Tile():x0(0), y0(0), x1(0), y1(0) {}
+    };
+
+    int                                     width;                      // The region width
+    int                                     height;                     // The region height
+    int                                     nbColumns;                  // The number of tiles per row
+    int                                     nbRows;                     // The number of tile rows
+    int                                     numberOfPixels;             // The number of damaged pixels
+    bool                                    changed;                    // Has the region changed since the last getRects
+    std::vector<Tile>                       tiles;                      // The tiles grid (allocated on first use)
+    std::vector<int>                        dirtyTiles;                 // The index of the damaged tiles
+    std::vector<int>                        openRects;                  // The rects of the previous row (getRects)
+    std::vector<int>                        nextRects;                  // The rects of the current row (getRects)
+    SDL_Rect *                              rects;                      // The update rects (borrowed from the pool)
+    int                                     nbRects;                    // The number of update rects
+    int                                     capacity;                   // The size of the rects array
+    std::vector<int>                        tileRects;                  // The rect covering each tile (-1 if none)
+    std::vector<int>                        stamps;                     // The last query of each rect (findRects)
+    int                                     stamp;                      // The current query (findRects)
+    bool                                    banded;                     // Are the rects built by tile rows
+
+    /**
+     * Merge the tiles boxes into rects
+     * @return the number of rects, -1 if the array is too small
+     */
+    int merge();
+
+    /**
+     * Build one rect per tile row (coarser region), the rows with the same range are merged
+     * @return the number of rects
+     */
+    int bands();
+
+    /**
+     * Get an array from the pool of update rects
+     * @param _capacity is the needed size, updated with the real size of the array
+     * @return the array
+     */
+    static SDL_Rect * acquireRects(int & _capacity);
+
+    /**
+     * Give an array back to the pool of update rects
+     * @param _rects is the array
+     * @param _capacity is the size of the array
+     */
+    static void releaseRects(SDL_Rect * _rects, int _capacity);
+
+    Region(const Region &);
+    Region & operator=(const Region &);
+
+public:
+    Region():width(0), height(0), nbColumns(0), nbRows(0), numberOfPixels(0), changed(false),
+             rects(0), nbRects(0), capacity(0), stamp(0), banded(false) {}
+    ~Region() { releaseRects(rects, capacity); }
+
+    /**
+     * Set the region size (the region is cleared if the size changes)
+     * @param _width is the region width
+     * @param _height is the region height
+     * @return true if the size has changed
+     */
+    bool resize(int _width, int _height);
+
+    /**
+     * Add a damaged rect
+     * @param _rect is the rect (clipped to the region)
+     * @return the number of new damaged pixels
+     */
+    int add(const SDL_Rect * _rect);
+
+    /**
+     * Clear the region
+     */
+    void clear();
+
+    /** Accessors */
+    int                                     getNumberOfPixels() const   { return numberOfPixels; }
+    bool                                    isFull() const              { return numberOfPixels>=width*height; }
+    bool                                    hasChanged() const          { return changed; }
+
+    /**
+     * Get the region as a list of rects: the tiles boxes are merged horizontally then vertically
+     * (or by tile rows if there are more than nbRectsMax rects)
+     * @param _nbRects is the number of rects (output)
+     * @return the rects array (valid until the next clear)
+     */
+    SDL_Rect * getRects(int & _nbRects);
+
+    /**
+     * Find the rects intersecting an area: only the tiles covered by the area are visited
+     * (or the rects if there are less rects than tiles). The rects must be built first (getRects)
+     * @param _area is the area
+     * @param _indices is the list of the rects index (output, appended)
+     * @return the number of found rects
+     */
+    int findRects(const SDL_Rect * _area, std::vector<int> & _indices);
+
+    /**
+     * The cost model between a full update and an update of the rects only
+     * @param _pixels is the number of damaged pixels
+     * @param _nbRects is the number of rects
+     * @param _width is the surface width
+     * @param _height is the surface height
+     * @return true if the full update is cheaper
+     */
+    static bool isFullUpdateCheaper(int _pixels, int _nbRects, int _width, int _height)
+    {
+        return _pixels + _nbRects*rectCost >= _width*_height;
+    }
+};
+
+}
+
+#endif
@@ -56,6 +56,22 @@ public:
      */
     bool render(SDL_Surface * _surface, SDL_Rect * _offset = 0);
 
+    /**
+     * Prepare the render of the object and get its blit command
+     * @param _surface is the surface to fill
+     * @param _offset is the parent offset
+     * @param _command is the blit command (output)
+     * @return true if there is something to blit
+     */
+    bool compile(SDL_Surface * _surface, SDL_Rect * _offset, DisplayList::Command * _command);
+
+    /**
+     * Get the area fully covered by the object when it is rendered (used for the occlusion)
+     * @param _rect is the opaque area in the parent coordinates (output)
+     * @return true if the object is opaque on a not empty area
+     */
+    bool getOpaqueRect(SDL_Rect * _rect);
+
     /**
      * Log the solid to the standard output
      * @param _rank is the log rank
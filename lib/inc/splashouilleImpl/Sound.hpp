@@ -21,6 +21,7 @@ SPLASHOUILLE.  If not, see http://www.gnu.org/licenses/
 #include <splashouille/Defines.hpp>
 #include <splashouille/Sound.hpp>
 #include <splashouilleImpl/Object.hpp>
+#include <map>
 
 #include <SDL_mixer.h>
 
@@ -20,8 +20,12 @@ SPLASHOUILLE.  If not, see http://www.gnu.org/licenses/
 
 #include <splashouille/Style.hpp>
 
+#include <SDL.h>
+#include <vector>
+
 namespace splashouilleImpl
 {
+class Object;
 
 const static int    percent = 96;   // 16-dividable hundred for percentage size computation
 
@@ -32,19 +36,21 @@ const static int    percent = 96;   // 16-dividable hundred for percentage size
 class Style : public splashouille::Style
 {
 private:
+    /**
+     * The float properties are stored in one array so they are mixed as a vector (two SSE2 registers)
+     */
+    enum Lane { laneLeft=0, laneTop, laneWidth, laneHeight, lanePositionX, lanePositionY, laneRelativeLeft, laneRelativeTop,
+                nbLanes };
+    const static int    laneBits[nbLanes];          // The property bit of each lane
+
     long        bitmap;                             // What properties are currently used
     int         changed;                            // Has the style been changed
-    float       left;                               // The x-axis left value in pixels
-    float       top;                                // The y-axis top value in pixels
-    float       relativeLeft;                       // The additional x-axis left value in pixels
-    float       relativeTop;                        // The additional y-axis top value in pixels
-    float       width;                              // The width value in pixels
-    float       height;                             // The height value in pixels
+    float       values[nbLanes];                    // The left, top, width, height, position, relative left and top values
     int         backgroundColor[3];                 // The RGB background color
-    float       position[2];                        // The position offset
     bool        display;                            // The display state
     int         opacity;                            // The opacity;
     int         user;                               // The user attributes
+    Object *    owner;                              // The object woken up by the changes (0 for the computed styles)
 
     /**
      * Mix two values regarding their ratio
@@ -56,7 +62,42 @@ private:
      */
     int         d(float _value1, float _value2) const { return (static_cast<int>(_value1)!=static_cast<int>(_value2)); }
 
+    /**
+     * Wake the owner object up (a sleeping object does not see the changes of its style otherwise)
+     */
+    void        wakeOwner();
+
+    /**
+     * Record the write of a property and wake the owner up if the property has changed or is new
+     * @param _changed is 1 if the property value has changed
+     * @param _property is the property
+     */
+    void        note(int _changed, int _property)
+                    { if (owner && (_changed || !(bitmap&(1<<_property)))) { wakeOwner(); }
+                      changed|=(_changed<<_property); bitmap|=(1<<_property); }
+
+    /**
+     * Mix the properties which are not stored in the lanes, then add the new properties
+     * @param _style is the style to mix
+     * @param _both is the bitmap of the common properties
+     * @param _ratio is the ratio of the new style
+     */
+    void        mixOthers(const Style * _style, int _both, float _ratio);
+
 public:
+    /**
+     * The structure-of-arrays buffers of a batch of mixes: each lane is stored across the styles
+     */
+    class Lanes
+    {
+    public:
+        std::vector<float>  values[nbLanes];        // The lane values of the mixed styles
+        std::vector<float>  targets[nbLanes];       // The lane values of the styles to mix
+        std::vector<float>  ratios;                 // The ratio of each mix
+        std::vector<int>    common;                 // The common properties of each mix
+        std::vector<int>    moved;                  // The properties whose pixel value has moved
+    };
+
     Style();
     Style(libconfig::Setting & _setting);
     Style(splashouille::Style * _style);
@@ -78,6 +119,12 @@ public:
      */
     void        touch();
 
+    /**
+     * Set the object woken up by the changes of the style
+     * @param _owner is the object (0 for none)
+     */
+    void        setOwner(Object * _owner)       { owner = _owner; }
+
     /**
      * Set the style properties by copying another style
      * @param _style is the style to copy
@@ -90,6 +137,13 @@ public:
      */
     void        add(const splashouille::Style * _style);
 
+    /**
+     * Set some style properties by addying another style
+     * @param _style is the style to add
+     * @param _properties is the bitmap of the properties to add
+     */
+    void        add(const splashouille::Style * _style, long _properties);
+
     /**
      * Set the style properties by mixing another style regarding a ratio
      * @param _style is the style to mix
@@ -97,6 +151,17 @@ public:
      */
     void        mix(const splashouille::Style * _style, float _ratio);
 
+    /**
+     * Mix a batch of styles: same result as _styles[i]->mix(_targets[i], _ratios[i]) for each i
+     * (a style is mixed only once in a batch and is not the target of another mix)
+     * @param _styles are the styles to set
+     * @param _targets are the styles to mix
+     * @param _ratios are the ratios of the new styles
+     * @param _size is the number of mixes
+     * @param _lanes are the buffers of the batch
+     */
+    static void mix(Style * const * _styles, const Style * const * _targets, const float * _ratios, int _size, Lanes & _lanes);
+
     /**
      * Compare a style (only common properties)
      * @param _style is the style to compare
@@ -114,42 +179,51 @@ public:
     int         hasChanged() const              { return changed; }
     bool        getDisplay() const              { return display; }
     long        getBitmap() const               { return bitmap; }
-    float       getLeft() const                 { return left; }
-    float       getTop() const                  { return top; }
-    float       getRelativeLeft() const         { return relativeLeft; }
-    float       getRelativeTop() const          { return relativeTop; }
-    float       getWidth() const                { return width; }
-    float       getHeight() const               { return height; }
+    float       getLeft() const                 { return values[laneLeft]; }
+    float       getTop() const                  { return values[laneTop]; }
+    float       getRelativeLeft() const         { return values[laneRelativeLeft]; }
+    float       getRelativeTop() const          { return values[laneRelativeTop]; }
+    float       getWidth() const                { return values[laneWidth]; }
+    float       getHeight() const               { return values[laneHeight]; }
     void        getBackgroundColor(int & _red, int & _green, int & _blue) const;
     void        getPosition(float & _x, float & _y) const;
     int         getOpacity() const              { return opacity; }
     int         getUser() const                 { return user; }
 
+    /**
+     * Non virtual accessors of the concrete style (used by the render and update paths)
+     */
+    bool        isDisplayed() const             { return display; }
+    int         getAlpha() const                { return display?opacity:0; }
+    const int * getColor() const                { return backgroundColor; }
+    void        getArea(SDL_Rect * _position, SDL_Rect * _source) const
+                    { _position->x = values[laneLeft] + values[laneRelativeLeft]; _position->y = values[laneTop] + values[laneRelativeTop];
+                      _position->w = values[laneWidth]; _position->h = values[laneHeight];
+                      _source->x = values[lanePositionX]; _source->y = values[lanePositionY]; _source->w = _position->w; _source->h = _position->h; }
+
     int         hasChangedSinceLastTime()       { int ret=changed; changed=0; return ret; }
-    void        setLeft(float _left)            { changed|=(d(left,_left)<<__left); left = _left; bitmap|=(1<<__left); }
-    void        setTop(float _top)              { changed|=(d(top,_top)<<__top); top = _top; bitmap|=(1<<__top); }
-    void        setWidth(float _width)          { changed|=(d(width,_width)<<__width); width = _width; bitmap|=(1<<__width);}
-    void        setHeight(float _height)        { changed|=(d(height,_height)<<__height); height = _height; bitmap|=(1<<__height);}
+    void        setLeft(float _left)            { note(d(values[laneLeft],_left), __left); values[laneLeft] = _left; }
+    void        setTop(float _top)              { note(d(values[laneTop],_top), __top); values[laneTop] = _top; }
+    void        setWidth(float _width)          { note(d(values[laneWidth],_width), __width); values[laneWidth] = _width; }
+    void        setHeight(float _height)        { note(d(values[laneHeight],_height), __height); values[laneHeight] = _height; }
     void        setRelativeLeft(float _left)
-                    { changed|=(d(relativeLeft,_left)<<__relativeleft);relativeLeft=_left;bitmap|=(1<<__relativeleft); }
+                    { note(d(values[laneRelativeLeft],_left), __relativeleft); values[laneRelativeLeft] = _left; }
     void        setRelativeTop(float _top)
-                    { changed|=(d(relativeTop,_top)<<__relativetop);relativeTop=_top; bitmap|=(1<<__relativetop); }
+                    { note(d(values[laneRelativeTop],_top), __relativetop); values[laneRelativeTop] = _top; }
     void        setBackgroundColor(int _red, int _green, int _blue)
                     { _red      = (_red<0)?0:((_red>255)?255:_red);
                       _green    = (_green<0)?0:((_green>255)?255:_green);
                       _blue     = (_blue<0)?0:((_blue>255)?255:_blue);
-                      changed|=(((backgroundColor[0]!=_red)|(backgroundColor[1]!=_green)|(backgroundColor[2]!=_blue))<<__backgroundColor);
-                      backgroundColor[0] = _red; backgroundColor[1] = _green; backgroundColor[2] = _blue;
-                      bitmap|=(1<<__backgroundColor); }
-    void        setPositionX(float _x)          { changed|=(d(position[0],_x)<<__positionX); position[0]=_x; bitmap|=(1<<__positionX); }
-    void        setPositionY(float _y)          { changed|=(d(position[1],_y)<<__positionY); position[1]=_y; bitmap|=(1<<__positionY); }
+                      note((backgroundColor[0]!=_red)|(backgroundColor[1]!=_green)|(backgroundColor[2]!=_blue), __backgroundColor);
+                      backgroundColor[0] = _red; backgroundColor[1] = _green; backgroundColor[2] = _blue; }
+    void        setPositionX(float _x)          { note(d(values[lanePositionX],_x), __positionX); values[lanePositionX] = _x; }
+    void        setPositionY(float _y)          { note(d(values[lanePositionY],_y), __positionY); values[lanePositionY] = _y; }
     void        setPosition(float _x, float _y) { setPositionX(_x); setPositionY(_y); }
     void        setOpacity(int _opacity)
                     { _opacity = (_opacity<0)?0:((_opacity>255)?255:_opacity);
-                      changed|=(d(opacity,_opacity)<<__opacity); opacity = _opacity; bitmap|=(1<<__opacity); }
-    void        setDisplay(bool _display)
-                    { changed|=((_display!=display)<<__display); display=_display; bitmap|=(1<<__display); }
-    void        setUser(int _user)              { changed|=(d(user,_user)<<__user); user = _user; bitmap|=(1<<__user); }
+                      note(d(opacity,_opacity), __opacity); opacity = _opacity; }
+    void        setDisplay(bool _display)       { note(_display!=display, __display); display = _display; }
+    void        setUser(int _user)              { note(d(user,_user), __user); user = _user; }
 
 };
 
@@ -0,0 +1,70 @@
+/*
+Copyright 2011 JohannC
+
+This file is part of SPLASHOUILLE.
+
+SPLASHOUILLE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+SPLASHOUILLE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+SPLASHOUILLE.  If not, see http://www.gnu.org/licenses/
+*/
+
+#ifndef SPLASHOUILLEIMPL_SYMBOL_HPP_
+#define SPLASHOUILLEIMPL_SYMBOL_HPP_
+
+#include <string>
+#include <tr1/unordered_map>
+
+namespace splashouilleImpl
+{
+
+/**
+ * The global symbol table
+ * The object, tag, fashion and timeline ids are interned when they are imported: each string gets a
+ * small integer which is used as key by the hot paths. The names are never removed from the table.
+ * The table is locked: the ids are interned by the threaded import as well as by the main thread.
+ */
+class Symbol
+{
+public:
+    const static int                        none            = -1;       // The symbol of an unknown string
+    const static int                        empty           = 0;        // The symbol of the empty string
+
+    /**
+     * Get the symbol of a string (the string is interned if it is unknown)
+     * @param _name is the string
+     * @return the symbol
+     */
+    static int get(const std::string & _name);
+
+    /**
+     * Find the symbol of a string without interning it
+     * @param _name is the string
+     * @return the symbol (none if the string is unknown)
+     */
+    static int find(const std::string & _name);
+
+    /**
+     * Get the string of a symbol
+     * @param _symbol is the symbol
+     * @return the string (valid until the end of the program)
+     */
+    static const std::string & getName(int _symbol);
+
+    /**
+     * Get the number of interned strings
+     * @return the size of the table
+     */
+    static int getSize();
+};
+
+}
+
+#endif
+
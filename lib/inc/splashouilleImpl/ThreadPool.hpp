@@ -0,0 +1,97 @@
+/*
+Copyright 2011 JohannC
+
+This file is part of SPLASHOUILLE.
+
+SPLASHOUILLE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+SPLASHOUILLE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+SPLASHOUILLE.  If not, see http://www.gnu.org/licenses/
+*/
+
+
+#ifndef SPLASHOUILLEIMPL_THREADPOOL_HPP_
+#define SPLASHOUILLEIMPL_THREADPOOL_HPP_
+
+namespace splashouilleImpl
+{
+
+/**
+ * The global pool of worker threads for the parallel stages of the engine
+ * A stage is split into chunks of indices and the idle threads take the next chunk (the calling
+ * thread works too). The tasks of a stage must only change their own data, so the result of a stage
+ * does not depend on the threads which run it. The threads are started on the first parallel stage.
+ * The few global states used by the tasks (the profiling counters, the update rects pool) are locked
+ * by a guard, only while a stage is running.
+ */
+class ThreadPool
+{
+public:
+    const static int                        nbThreadsMax    = 16;       // The largest number of threads (caller included)
+
+    /**
+     * A parallel stage
+     */
+    class Task
+    {
+    public:
+        virtual ~Task() {}
+
+        /**
+         * Run the stage on a range of indices (called by any thread)
+         * @param _begin is the first index
+         * @param _end is the end of the range
+         */
+        virtual void run(int _begin, int _end) = 0;
+    };
+
+    /**
+     * Lock the global states shared by the tasks during its scope (no lock if no stage is running)
+     */
+    class Guard
+    {
+    private:
+        bool                                locked;                     // Has the guard locked the shared states
+
+        Guard(const Guard &);
+        Guard & operator=(const Guard &);
+    public:
+        Guard();
+        ~Guard();
+    };
+
+    /**
+     * Run a stage on the pool and wait for its end (the small stages are run by the calling thread)
+     * @param _task is the stage
+     * @param _size is the number of indices
+     * @param _grain is the number of indices of a chunk
+     */
+    static void run(Task * _task, int _size, int _grain);
+
+    /**
+     * Get the number of threads of the pool (caller included)
+     * @return the number of threads
+     */
+    static int getNbThreads();
+
+    /**
+     * Check if a stage is running (the nested stages are run serially)
+     * @return true if a stage is running
+     */
+    static bool isRunning();
+
+    /**
+     * Stop the worker threads (they are started again by the next parallel stage)
+     */
+    static void stop();
+};
+
+}
+
+#endif
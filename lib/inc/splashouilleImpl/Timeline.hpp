@@ -64,6 +64,12 @@ public:
      */
     void update(int _timestamp);
 
+    /**
+     * Get the timestamp of the next event (the timeline has nothing to run before)
+     * @return the timestamp (Fashion::never if there is no event left)
+     */
+    int getWakeTimestamp() const;
+
     /** Accessors */
     splashouille::Animation *    getAnimation();
 
@@ -30,39 +30,39 @@ SPLASHOUILLE.  If not, see http://www.gnu.org/licenses/
 using namespace splashouilleImpl;
 
 Animation::Animation(const std::string & _id, libconfig::Setting & _setting, splashouille::Library * _library) :
-    splashouilleImpl::Object(_id), numberOfPixels(0), nbUpdateRects(0), timeline(0), library(_library),
+    splashouilleImpl::Object(_id), numberOfPixels(0), nbUpdateRects(0), updateRects(0), timeline(0), library(_library),
     animationType(splashouille::Animation::group), parent(0), bg(color)
 {
     type = TYPE_ANIMATION;
+    setKind(this);
 
     crowd       = new Crowd(this);
-    memset(updateRects, 0, nbUpdateRectsMax*sizeof(SDL_Rect));
     initTimelines();
     import(_setting);
 
 }
 
 Animation::Animation(const std::string & _id, Animation * _animation UNUSED, splashouille::Library * _library) :
-    splashouilleImpl::Object(_id),numberOfPixels(0), nbUpdateRects(0), timeline(0), library(_library),
+    splashouilleImpl::Object(_id),numberOfPixels(0), nbUpdateRects(0), updateRects(0), timeline(0), library(_library),
     animationType(splashouille::Animation::group), parent(0), bg(color)
 {
     type = TYPE_ANIMATION;
+    setKind(this);
 
     crowd       = new Crowd(this);
-    memset(updateRects, 0, nbUpdateRectsMax*sizeof(SDL_Rect));
     initTimelines();
 
     // TODO
 }
 
 Animation::Animation(const std::string & _id, splashouille::Library * _library):
-    splashouilleImpl::Object(_id), numberOfPixels(0), nbUpdateRects(0), timeline(0), library(_library),
+    splashouilleImpl::Object(_id), numberOfPixels(0), nbUpdateRects(0), updateRects(0), timeline(0), library(_library),
     animationType(splashouille::Animation::group), parent(0), bg(color)
 {
     type = TYPE_ANIMATION;
+    setKind(this);
 
     crowd       = new Crowd(this);
-    memset(updateRects, 0, nbUpdateRectsMax*sizeof(SDL_Rect));
     initTimelines();
 }
 
@@ -79,7 +79,7 @@ Animation::~Animation()
 void Animation::initTimelines()
 {
     timeline = new Timeline(this);
-    timelines.insert(std::pair<std::string, Timeline*>("default", timeline));
+    timelines.insert(std::pair<int, Timeline*>(symbolDefault, timeline));
 }
 
 
@@ -123,7 +123,7 @@ bool Animation::import(libconfig::Setting & _setting)
                 timeline->import(library, setting[TIMELINE]);
                 std::string timelineId;
                 setting.lookupValue(TIMELINE_ID, timelineId);
-                timelines.insert(std::pair<std::string, Timeline*>(timelineId, timeline));
+                timelines.insert(std::pair<int, Timeline*>(Symbol::get(timelineId), timeline));
 
             }
         }
@@ -156,42 +156,16 @@ void Animation::addUpdateRect(const SDL_Rect * _updateRect)
         const splashouille::Style * style = fashion->getCurrent();
         if (numberOfPixels < style->getWidth() * style->getHeight())
         {
-            int first = -1;
-
-            // IT WOULD BE A GOOD IDEA TO CHECK IF THERE IS ANY INTERSECTION WITH PREVIOUS UPDATE RECTS
-            // BUT WITH A QUADRATIC COMPLEXITY, IT IS REMOVED FOR THE MOMENT
-            /*
-            for (int i=0; i<nbUpdateRects; i++)
+            // THE WHOLE SURFACE IS DAMAGED WHEN THE ANIMATION SIZE CHANGES
+            if (region.resize(style->getWidth(), style->getHeight()))
             {
-                if (first<0)
-                {
-                    if (splashouille::Engine::inter(&updateRects[i], &updateRect))
-                    {
-                        int pixels = updateRects[i].w * updateRects[i].h;
-                        splashouille::Engine::add(&updateRects[i], &updateRect);
-                        numberOfPixels += updateRects[i].w * updateRects[i].h - pixels;
-                        first = i;
-                    }
-                }
-                else
-                {
-                    if (splashouille::Engine::inter(&updateRects[first], &updateRects[i]))
-                    {
-                        int pixels = updateRects[first].w * updateRects[first].h;
-                        splashouille::Engine::add(&updateRects[first], &updateRects[i]);
-                        numberOfPixels += updateRects[first].w * updateRects[first].h - pixels - updateRects[i].w * updateRects[i].h;
-                        updateRects[i].x = updateRects[i].y = updateRects[i].w = updateRects[i].h = 0;
-                    }
-                }
+                SDL_Rect all = { 0, 0, static_cast<Uint16>(style->getWidth()), static_cast<Uint16>(style->getHeight()) };
+                region.add(&all);
             }
-            */
 
-            // ADD THE NEW UPDATE RECT IF IT DIDN'T INTERSECT ANYONE
-            if (nbUpdateRects<nbUpdateRectsMax && first<0)
-            {
-                splashouille::Engine::copy(&updateRects[nbUpdateRects++], &updateRect);
-                numberOfPixels+=updateRect.w*updateRect.h;
-            }
+            // THE REGION MERGES THE OVERLAPPING RECTS: THE PIXELS ARE COUNTED ONCE
+            region.add(&updateRect);
+            numberOfPixels = region.getNumberOfPixels();
 
             // DYNAMIC ANIMATIONS FORWARD THE UPDATE RECTS INFORMATION TO THE PARENT IF
             // IT WASN'T ALREADY DONE BY THE OBJECT::UPDATE METHOD (THE WHOLE ANIMATION IS ON MOVE)
@@ -222,17 +196,38 @@ bool Animation::update(int _timestamp)
     // UPDATE THE ANIMATION AS AN OBJECT
     // FOR STATIC ANIMATIONS, THIS CALL ONLY MATTERS THE FIRST TIME (THEN IT'S NOT SUPPOSED TO MOVE)
     hasChanged=splashouilleImpl::Object::update(_timestamp);
-    if (!isStatic() && hasChanged && parent) { parent->addUpdateRect(updateArea); }
+    if (!isStatic() && hasChanged && parent) { parent->addUpdateRect(updateArea); parent->addUpdateRect(position); }
 
-    // UPDATE THE TIMELINE IF THE ANIMATION IS NOT FINAL
+    // UPDATE THE TIMELINE IF THE ANIMATION IS NOT FINAL (AND ONLY WHEN ITS NEXT EVENT IS DUE)
     if (nbUpdates<=1 || animationType!=splashouille::Animation::final)
     {
-        timeline->update(_timestamp);
+        if (_timestamp>=timeline->getWakeTimestamp()) { timeline->update(_timestamp); }
         crowd->update(_timestamp);
     }
     return ret;
 }
 
+/**
+ * Get the next timestamp the animation, its timeline or its crowd changes at (to call after the update)
+ * @return the timestamp (Fashion::never if nothing changes by itself)
+ */
+int Animation::getWakeTimestamp() const
+{
+    // A NEW OR RESTARTED ANIMATION IS UPDATED AT ONCE
+    if (!nbUpdates || initialTimestamp<0) { return -Fashion::never; }
+
+    int ret = Object::getWakeTimestamp();
+    if (nbUpdates<=1 || animationType!=splashouille::Animation::final)
+    {
+        int wake = timeline->getWakeTimestamp();
+        if (wake<ret) { ret = wake; }
+        wake = crowd->getWakeTimestamp();
+        if (wake<ret) { ret = wake; }
+    }
+
+    return ret;
+}
+
 /**
  * Handle the mouseEvent
  * @param _timestampInMilliSeconds is the current timestamp
@@ -265,24 +260,33 @@ bool Animation::mouseEvent(int _timestampInMilliSeconds, int _x, int _y, bool _c
  */
 bool Animation::changeTimeline(const std::string & _timelineId, bool _updateInitialTimeStamp )
 {
-    bool ret = false;
-    for (TimelineMap::iterator vIt=timelines.begin(); vIt!=timelines.end(); vIt++)
+    return changeTimeline(Symbol::find(_timelineId), _updateInitialTimeStamp);
+}
+
+/**
+ * Change the current timeline
+ * @param _timelineSymbol is the timeline Id as symbol
+ * @return true if the timeline is found
+ */
+bool Animation::changeTimeline(int _timelineSymbol, bool _updateInitialTimeStamp )
+{
+    bool                    ret = false;
+    TimelineMap::iterator   vIt = timelines.find(_timelineSymbol);
+
+    if (vIt!=timelines.end())
     {
-        if (!vIt->first.compare(_timelineId))
-        {
-            // Update the animation initialtimestamp
-            ret = true;
-            timeline = vIt->second;
-            timeline->clear();
+        // Update the animation initialtimestamp
+        ret = true;
+        timeline = vIt->second;
+        timeline->clear();
 
-            if (_updateInitialTimeStamp) { initialTimestamp = -1; }
-        }
+        if (_updateInitialTimeStamp) { initialTimestamp = -1; }
     }
 
     if (Engine::debug)
     {
         std::cout<<std::setw(STD_LABEL)<<std::left<<"Animation::changeTimeline"<<" (id:"<<id
-            <<") (timeline: "<<_timelineId<<") (timestamp: "<<initialTimestamp<<" ["<<_updateInitialTimeStamp<<"]) (ret: "
+            <<") (timeline: "<<Symbol::getName(_timelineSymbol)<<") (timestamp: "<<initialTimestamp<<" ["<<_updateInitialTimeStamp<<"]) (ret: "
             <<(ret?"OK":"KO")<<")"<<std::endl;
     }
 
@@ -301,14 +305,17 @@ void Animation::fillWithBackground()
         const splashouille::Style * style = fashion->getCurrent();
         int r,g,b; style->getBackgroundColor(r, g, b);
 
+        SDL_Rect all = { 0, 0, static_cast<Uint16>(style->getWidth()), static_cast<Uint16>(style->getHeight()) };
+
+        // THE AREAS COVERED BY AN OPAQUE OBJECT ARE NOT FILLED
         if (numberOfPixels >= style->getWidth() * style->getHeight())
         {
-            SDL_FillRect(surface, 0, SDL_MapRGBA(surface->format, r, g, b, 255));
+            if (!crowd->isOccluded(&all)) { SDL_FillRect(surface, 0, SDL_MapRGBA(surface->format, r, g, b, 255)); }
         }
         else
         for (int i=0; i<nbUpdateRects; i++)
         {
-            SDL_FillRect(surface, &updateRects[i], SDL_MapRGBA(surface->format, r, g, b, 255));
+            if (!crowd->isOccluded(&updateRects[i])) { SDL_FillRect(surface, &updateRects[i], SDL_MapRGBA(surface->format, r, g, b, 255)); }
         }
     }
 }
@@ -321,8 +328,57 @@ void Animation::fillWithBackground()
  */
 bool Animation::render(SDL_Surface * _surface, SDL_Rect * _offset)
 {
-    bool                        ret     = true;
-    const splashouille::Style * style   = fashion->getCurrent();
+    DisplayList::Command command;
+    if (compile(_surface, _offset, &command)) { DisplayList::blit(_surface, command); }
+    return true;
+}
+
+/**
+ * Prepare the render of the object and get its blit command
+ * @param _surface is the surface to fill
+ * @param _offset is the parent offset
+ * @param _command is the blit command (output)
+ * @return true if there is something to blit
+ */
+bool Animation::compile(SDL_Surface * _surface, SDL_Rect * _offset, DisplayList::Command * _command)
+{
+    bool                        ret     = false;
+    const Style *               style   = fashion->getCurrent();
+
+    prepareSurface(_surface);
+
+    if (isStatic() || numberOfPixels) { renderCrowd(_offset); }
+
+    // Blit the animation surface if it is not static
+    if (!isStatic() && style->isDisplayed())
+    {
+        _command->surface   = surface;
+        _command->alpha     = style->getAlpha();
+        ret                 = DisplayList::place(position, source, _offset, _command);
+    }
+
+    if (parent) { clear(); }
+
+    return ret;
+}
+
+/**
+ * Render the crowd into the animation surface if it is damaged, then clear the damage
+ * (not static animations only, the surface is built first by prepareSurface)
+ */
+void Animation::renderSurface()
+{
+    if (numberOfPixels) { renderCrowd(0); }
+    clear();
+}
+
+/**
+ * Build the animation surface if it is missing or too small
+ * @param _surface is the parent surface (the surface of the static animations)
+ */
+void Animation::prepareSurface(SDL_Surface * _surface)
+{
+    const Style *               style   = fashion->getCurrent();
 
     // Rebuild the surface if it is too small (create a greater surface than needed for avoiding re-creation)
     if (!surface || (surface->w<position->w || surface->h<position->h))
@@ -344,68 +400,61 @@ bool Animation::render(SDL_Surface * _surface, SDL_Rect * _offset)
             SDL_FillRect(surface, 0, SDL_MapRGBA(surface->format, r, g, b, 255));
         }
     }
+}
+
+/**
+ * Render the crowd into the surface (in the damaged parts only)
+ * @param _offset is the parent offset
+ */
+void Animation::renderCrowd(SDL_Rect * _offset)
+{
+    prepareUpdateRects();
 
-    if (isStatic() || numberOfPixels)
+    // Update the offset of the current animation depending on its static attribute
+    SDL_Rect offset;
+    SDL_Rect * p_offset = 0;
+    if (isStatic())
     {
-        // Remove the modified areas by filling with transparent color
-        fillWithBackground();
+        offset.x = (_offset?_offset->x : 0) + position->x;
+        offset.y = (_offset?_offset->y : 0) + position->y;
+        offset.w = _offset?min(_offset->x+_offset->w, offset.x+position->w) - offset.x : position->w;
+        offset.h = _offset?min(_offset->y+_offset->h, offset.y+position->h) - offset.y : position->h;
+        p_offset = & offset;
+    }
 
-        // Update the offset of the current animation depending on its static attribute
-        SDL_Rect offset;
-        SDL_Rect * p_offset = 0;
-        if (isStatic())
-        {
-            offset.x = (_offset?_offset->x : 0) + position->x;
-            offset.y = (_offset?_offset->y : 0) + position->y;
-            offset.w = _offset?min(_offset->x+_offset->w, offset.x+position->w) - offset.x : position->w;
-            offset.h = _offset?min(_offset->y+_offset->h, offset.y+position->h) - offset.y : position->h;
-            p_offset = & offset;
-        }
+    // Find the objects hidden by opaque objects (the covered areas are not filled either)
+    crowd->occlude(surface, p_offset);
 
-        // Render the crowd
-        crowd->render(surface, p_offset);
-    }
+    // Remove the modified areas by filling with transparent color
+    fillWithBackground();
 
-    // Draw the animation surface if it is not static
-    if (!isStatic() && style->getDisplay())
-    {
-        const splashouille::Style * style = fashion->getCurrent();
-        if (style->getDisplay())
-        {
-            SDL_SetAlpha(surface, SDL_SRCALPHA | SDL_RLEACCEL, style->getOpacity());
-
-            // Handle the position regarding the parent offset (if any)
-            SDL_Rect vPosition;
-            SDL_Rect vSource;
-            splashouille::Engine::copy(&vPosition, position);
-            splashouille::Engine::copy(&vSource, source);
-            if (_offset) {
-                splashouille::Engine::offset(&vPosition, _offset);
-
-                if (vPosition.y<_offset->y)
-                {
-                    if (vPosition.h>(_offset->y-vPosition.y)) { vPosition.h-=(_offset->y-vPosition.y); } else { vPosition.h = 0; }
-                    vSource.y-=(vPosition.y-_offset->y);
-                    vPosition.y = _offset->y;
-                }
-
-                if (vPosition.x<_offset->x)
-                {
-                    if (vPosition.w>(_offset->x-vPosition.x)) { vPosition.w-=(_offset->x-vPosition.x); } else { vPosition.w = 0; }
-                    vSource.x-=(vPosition.x-_offset->x);
-                    vPosition.x = _offset->x;
-                }
-
-                vSource.w = vPosition.w;
-                vSource.h = vPosition.h;
-            }
+    // Render the crowd
+    crowd->render(surface, p_offset);
+}
 
-            // Draw the image
-            if (vPosition.w>0 && vPosition.h>0) { SDL_BlitSurface(surface, &vSource, _surface, &vPosition); }
-        }
-    }
+/**
+ * Get the area fully covered by the animation when it is rendered (used for the occlusion)
+ * Only the not static animations with their own surface may be opaque
+ * @param _rect is the opaque area in the parent coordinates (output)
+ * @return true if the animation is opaque on a not empty area
+ */
+bool Animation::getOpaqueRect(SDL_Rect * _rect)
+{
+    const Style * style = fashion->getCurrent();
 
-    if (parent) { clear(); }
+    bool ret = !isStatic() && style->getAlpha()>=255 && surface &&
+               !surface->format->Amask && source->x>=0 && source->y>=0;
+
+    if (ret)
+    {
+        int w = surface->w-source->x; if (w>position->w) { w = position->w; }
+        int h = surface->h-source->y; if (h>position->h) { h = position->h; }
+        _rect->x = position->x;
+        _rect->y = position->y;
+        _rect->w = w>0?w:0;
+        _rect->h = h>0?h:0;
+        ret = (_rect->w && _rect->h);
+    }
 
     return ret;
 }
@@ -0,0 +1,244 @@
+/*
+Copyright 2011 JohannC
+
+This file is part of SPLASHOUILLE.
+
+SPLASHOUILLE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+SPLASHOUILLE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+SPLASHOUILLE.  If not, see http://www.gnu.org/licenses/
+*/
+
+
+#include <splashouilleImpl/Blitter.hpp>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace splashouilleImpl;
+
+/** The colors and the alpha channel of the handled 32 bits pixels */
+const static Uint32 colorMask   = 0x00ffffff;
+const static Uint32 alphaMask   = 0xff000000;
+
+/**
+ * Blend the colors of a source pixel over a destination pixel with the SDL 1.2 formula
+ * d+((s-d)*a>>8), computed as (s*a+d*(256-a))>>8 (the alpha byte is 0)
+ * @param _s is the source pixel
+ * @param _d is the destination pixel
+ * @param _a is the alpha
+ * @return the blended colors
+ */
+static inline Uint32 blend(Uint32 _s, Uint32 _d, Uint32 _a)
+{
+    Uint32 rb   = (((_s&0xff00ff)*_a + (_d&0xff00ff)*(256-_a))>>8)&0xff00ff;
+    Uint32 g    = (((_s&0x00ff00)*_a + (_d&0x00ff00)*(256-_a))>>8)&0x00ff00;
+    return rb|g;
+}
+
+#ifdef __SSE2__
+/**
+ * Blend 4 source pixels over 4 destination pixels (the 8 bits channels are widened to 16 bits)
+ * @param _s is the source pixels
+ * @param _d is the destination pixels
+ * @param _aLo is the alpha of the channels of the 2 first pixels
+ * @param _aHi is the alpha of the channels of the 2 last pixels
+ * @return the blended pixels (the alpha byte is not relevant)
+ */
+static inline __m128i blend(__m128i _s, __m128i _d, __m128i _aLo, __m128i _aHi)
+{
+    const __m128i   zero    = _mm_setzero_si128();
+    const __m128i   full    = _mm_set1_epi16(256);
+
+    __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(_s, zero), _aLo),
+                               _mm_mullo_epi16(_mm_unpacklo_epi8(_d, zero), _mm_sub_epi16(full, _aLo)));
+    __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(_s, zero), _aHi),
+                               _mm_mullo_epi16(_mm_unpackhi_epi8(_d, zero), _mm_sub_epi16(full, _aHi)));
+
+    return _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8));
+}
+
+static inline __m128i load(const Uint32 * _p)          { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(_p)); }
+static inline void store(Uint32 * _p, __m128i _v)      { _mm_storeu_si128(reinterpret_cast<__m128i*>(_p), _v); }
+#endif
+
+/**
+ * Copy the opaque pixels of a row (the colorkey pixels are skipped)
+ * @param _s is the source row
+ * @param _d is the destination row
+ * @param _n is the number of pixels
+ * @param _key is the colorkey
+ */
+static void colorKeyRow(const Uint32 * _s, Uint32 * _d, int _n, Uint32 _key)
+{
+    int i = 0;
+#ifdef __SSE2__
+    const __m128i key = _mm_set1_epi32(_key);
+    for (; i+4<=_n; i+=4)
+    {
+        __m128i s = load(_s+i);
+        __m128i m = _mm_cmpeq_epi32(s, key);
+        store(_d+i, _mm_or_si128(_mm_and_si128(m, load(_d+i)), _mm_andnot_si128(m, s)));
+    }
+#endif
+    for (; i<_n; i++) { if (_s[i]!=_key) { _d[i] = _s[i]; } }
+}
+
+/**
+ * Blend a row with the surface alpha (the colorkey pixels are skipped if any)
+ * @param _s is the source row
+ * @param _d is the destination row
+ * @param _n is the number of pixels
+ * @param _alpha is the surface alpha
+ * @param _hasKey is true if the source has a colorkey
+ * @param _key is the colorkey
+ */
+static void alphaRow(const Uint32 * _s, Uint32 * _d, int _n, Uint32 _alpha, bool _hasKey, Uint32 _key)
+{
+    int i = 0;
+#ifdef __SSE2__
+    const __m128i a     = _mm_set1_epi16(_alpha);
+    const __m128i opaque= _mm_set1_epi32(alphaMask);
+    const __m128i key   = _mm_set1_epi32(_key);
+    for (; i+4<=_n; i+=4)
+    {
+        __m128i s = load(_s+i);
+        __m128i d = load(_d+i);
+        __m128i r = _mm_or_si128(blend(s, d, a, a), opaque);
+        if (_hasKey)
+        {
+            __m128i m = _mm_cmpeq_epi32(s, key);
+            r = _mm_or_si128(_mm_and_si128(m, d), _mm_andnot_si128(m, r));
+        }
+        store(_d+i, r);
+    }
+#endif
+    for (; i<_n; i++) { if (!_hasKey || _s[i]!=_key) { _d[i] = blend(_s[i], _d[i], _alpha)|alphaMask; } }
+}
+
+/**
+ * Blend a row with the alpha channel of the source (the alpha byte of the destination is kept)
+ * @param _s is the source row
+ * @param _d is the destination row
+ * @param _n is the number of pixels
+ */
+static void pixelAlphaRow(const Uint32 * _s, Uint32 * _d, int _n)
+{
+    int i = 0;
+#ifdef __SSE2__
+    const __m128i zero  = _mm_setzero_si128();
+    const __m128i alpha = _mm_set1_epi32(alphaMask);
+    const __m128i color = _mm_set1_epi32(colorMask);
+    for (; i+4<=_n; i+=4)
+    {
+        __m128i s       = load(_s+i);
+        __m128i sAlpha  = _mm_and_si128(s, alpha);
+
+        // THE FULLY TRANSPARENT PIXELS ARE SKIPPED 4 AT A TIME (THE SPRITES BORDERS)
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(sAlpha, zero))==0xffff) { continue; }
+
+        // EACH PIXEL ALPHA IS SPREAD ON ITS 4 CHANNELS
+        __m128i aLo     = _mm_shufflehi_epi16(_mm_shufflelo_epi16(_mm_unpacklo_epi8(s, zero), 0xff), 0xff);
+        __m128i aHi     = _mm_shufflehi_epi16(_mm_shufflelo_epi16(_mm_unpackhi_epi8(s, zero), 0xff), 0xff);
+        __m128i d       = load(_d+i);
+        __m128i r       = blend(s, d, aLo, aHi);
+
+        // THE OPAQUE PIXELS ARE COPIED, AS SDL DOES
+        __m128i m       = _mm_cmpeq_epi32(sAlpha, alpha);
+        r = _mm_or_si128(_mm_and_si128(m, s), _mm_andnot_si128(m, r));
+        store(_d+i, _mm_or_si128(_mm_and_si128(r, color), _mm_and_si128(d, alpha)));
+    }
+#endif
+    for (; i<_n; i++)
+    {
+        Uint32 a = _s[i]>>24;
+        if (a==SDL_ALPHA_OPAQUE)    { _d[i] = (_s[i]&colorMask)|(_d[i]&alphaMask); }
+        else if (a)                 { _d[i] = blend(_s[i], _d[i], a)|(_d[i]&alphaMask); }
+    }
+}
+
+/**
+ * Get the blit path of a source
+ * @param _source is the source surface
+ * @param _alpha is the surface alpha
+ * @return the blit path
+ */
+Blitter::Mode Blitter::classify(const SDL_Surface * _source, Uint8 _alpha)
+{
+    const SDL_PixelFormat * format  = _source->format;
+    bool                    hasKey  = (_source->flags&SDL_SRCCOLORKEY);
+
+    // ONLY THE 8 BITS CHANNELS WITH THE ALPHA ON THE HIGH BYTE (IF ANY)
+    if (format->BytesPerPixel!=4 || (format->Rmask|format->Gmask|format->Bmask)!=colorMask ||
+        (format->Amask && format->Amask!=alphaMask) || SDL_MUSTLOCK(_source))
+    {
+        return sdl;
+    }
+
+    if (format->Amask)                  { return pixelAlpha; }
+    if (_alpha==SDL_ALPHA_OPAQUE)       { return hasKey?colorKey:copy; }
+    return hasKey?colorKeyAlpha:alpha;
+}
+
+/**
+ * Check if the engine blitter can blit a source into a destination (same colors layout, no lock)
+ * @param _source is the source surface
+ * @param _destination is the destination surface
+ * @return true if the engine blitter can be used
+ */
+bool Blitter::accepts(const SDL_Surface * _source, const SDL_Surface * _destination)
+{
+    const SDL_PixelFormat * source      = _source->format;
+    const SDL_PixelFormat * destination = _destination->format;
+
+    // THE SOURCE IS CHECKED AGAIN: SDL RLE-ENCODES IT ON ITS FIRST BLIT WITH SDL_RLEACCEL
+    return (_source!=_destination && destination->BytesPerPixel==4 && !destination->Amask &&
+            source->Rmask==destination->Rmask && source->Gmask==destination->Gmask && source->Bmask==destination->Bmask &&
+            !SDL_MUSTLOCK(_source) && !SDL_MUSTLOCK(_destination) && !(_destination->flags&SDL_HWSURFACE));
+}
+
+/**
+ * Blit a source (the rects are already clipped)
+ * @param _mode is the blit path (not sdl)
+ * @param _source is the source surface
+ * @param _sourceRect is the source rect
+ * @param _destination is the destination surface
+ * @param _position is the destination position
+ * @param _alpha is the surface alpha
+ */
+void Blitter::blit(Mode _mode, const SDL_Surface * _source, const SDL_Rect * _sourceRect,
+                   SDL_Surface * _destination, const SDL_Rect * _position, Uint8 _alpha)
+{
+    const Uint8 *   s       = static_cast<const Uint8*>(_source->pixels) + _sourceRect->y*_source->pitch + _sourceRect->x*4;
+    Uint8 *         d       = static_cast<Uint8*>(_destination->pixels) + _position->y*_destination->pitch + _position->x*4;
+    int             w       = _sourceRect->w;
+    int             h       = _sourceRect->h;
+    Uint32          key     = _source->format->colorkey;
+
+    // THE WHOLE ROWS OF BOTH SURFACES ARE CONTIGUOUS: ONE COPY
+    if (_mode==copy && w*4==_source->pitch && w*4==_destination->pitch) { w *= h; h = 1; }
+
+    for (int y=0; y<h; y++, s+=_source->pitch, d+=_destination->pitch)
+    {
+        const Uint32 *  sRow = reinterpret_cast<const Uint32*>(s);
+        Uint32 *        dRow = reinterpret_cast<Uint32*>(d);
+
+        switch (_mode)
+        {
+        case copy:          memcpy(dRow, sRow, w*4); break;
+        case colorKey:      colorKeyRow(sRow, dRow, w, key); break;
+        case alpha:         alphaRow(sRow, dRow, w, _alpha, false, key); break;
+        case colorKeyAlpha: alphaRow(sRow, dRow, w, _alpha, true, key); break;
+        case pixelAlpha:    pixelAlphaRow(sRow, dRow, w); break;
+        default:            break;
+        }
+    }
+}
@@ -19,46 +19,401 @@ SPLASHOUILLE.  If not, see http://www.gnu.org/licenses/
 #include <splashouilleImpl/Object.hpp>
 #include <splashouilleImpl/Engine.hpp>
 #include <splashouilleImpl/Animation.hpp>
+#include <splashouilleImpl/Solid.hpp>
+#include <splashouilleImpl/Image.hpp>
+#include <splashouilleImpl/Sound.hpp>
+#include <splashouilleImpl/Map.hpp>
 #include <splashouilleImpl/Crowd.hpp>
 #include <splashouilleImpl/Fashion.hpp>
 #include <splashouilleImpl/Style.hpp>
+#include <splashouilleImpl/ThreadPool.hpp>
 #include <iostream>
 #include <iomanip>
-#include <limits>
+#include <algorithm>
 
 #include <SDL.h>
 
-#define CMP(a,b,o) ((o)?(a<=b):(b<=a))
-
 using namespace splashouilleImpl;
 
 int Crowd::garbageNumber = 0;
 
-Crowd::Crowd(Animation * _animation): animation(_animation) { garbageNumber++; }
-Crowd::~Crowd() { garbageNumber--; }
+Crowd::Crowd(Animation * _animation): sequence(0), traversals(0), holes(false), animation(_animation), occlusionReady(false)
+{
+    garbageNumber++;
+}
+Crowd::~Crowd()
+{
+    // THE REMAINING OBJECTS ARE STILL ALIVE (THE DELETED ONES HAVE LEFT THE CROWD)
+    for (ObjectMap::iterator it=library.begin(); it!=library.end(); it++)
+    {
+        if (it->second->container==this) { it->second->container = 0; }
+    }
+    garbageNumber--;
+}
+
+Crowd::Entry::Entry(Object * _object):
+    object(_object), zIndex(_object->crowdZIndex), sequence(_object->crowdSequence) {}
+
+Crowd::Wake::Wake(Object * _object, int _timestamp):
+    timestamp(_timestamp), object(_object), zIndex(_object->crowdZIndex), sequence(_object->crowdSequence),
+    stamp(_object->wakeStamp) {}
+
+/**
+ * Check if an object sleeps between its updates (the animations and the maps are updated at each frame)
+ * @param _object is the object
+ * @return true if the object is updated by the wake-up queue
+ */
+bool Crowd::isSleeper(const Object * _object)
+{
+    return (_object->kind!=Object::kindAnimation && _object->kind!=Object::kindMap);
+}
+
+/**
+ * Compare two entries regarding their z-index then their insertion order
+ * @param _a is the first entry
+ * @param _b is the second entry
+ * @return true if _a is rendered before _b
+ */
+bool Crowd::before(const Entry & _a, const Entry & _b)
+{
+    return (_a.zIndex<_b.zIndex) || (_a.zIndex==_b.zIndex && _a.sequence<_b.sequence);
+}
+
+/**
+ * Compare two entries regarding their tag then their z-index and their insertion order
+ * @param _a is the first entry
+ * @param _b is the second entry
+ * @return true if _a is before _b
+ */
+bool Crowd::beforeInTag(const Entry & _a, const Entry & _b)
+{
+    return (_a.object->tagSymbol<_b.object->tagSymbol) ||
+           (_a.object->tagSymbol==_b.object->tagSymbol && before(_a, _b));
+}
+
+/**
+ * Insert an entry in a z-sorted array (binary search of the position)
+ * @param _entries is the z-sorted array
+ * @param _entry is the entry to insert
+ */
+void Crowd::place(Entries & _entries, const Entry & _entry)
+{
+    _entries.insert(std::upper_bound(_entries.begin(), _entries.end(), _entry, &Crowd::before), _entry);
+}
+
+/**
+ * Merge a sorted batch of entries into a z-sorted array (in place, from the end)
+ * @param _entries is the z-sorted array
+ * @param _begin is the first entry of the sorted batch
+ * @param _end is the end of the sorted batch
+ */
+void Crowd::merge(Entries & _entries, Entries::const_iterator _begin, Entries::const_iterator _end)
+{
+    if (_begin!=_end)
+    {
+        int i = _entries.size()-1;
+        int w = _entries.size()+(_end-_begin)-1;
+
+        _entries.resize(w+1, *_begin);
+        for (Entries::const_iterator j=_end; j!=_begin; )
+        {
+            if (i>=0 && before(*(j-1), _entries[i]))    { _entries[w--] = _entries[i--]; }
+            else                                        { _entries[w--] = *(--j); }
+        }
+    }
+}
+
+/**
+ * Find an object in a z-sorted array (binary search of its crowd handle)
+ * @param _entries is the z-sorted array
+ * @param _object is the object to find
+ * @return the index of the object (-1 if not found)
+ */
+int Crowd::find(const Entries & _entries, Object * _object)
+{
+    Entries::const_iterator it = std::lower_bound(_entries.begin(), _entries.end(), Entry(_object), &Crowd::before);
+    return (it!=_entries.end() && it->object==_object)?it-_entries.begin():-1;
+}
 
 /**
- * Return a pointer to the tag-related list (create if doesn't exist)
- * @param _tag is the tagged list
- * @return the list
+ * Give a new crowd handle (z-index and insertion order) to an object
+ * @param _object is the object
+ * @return the entry of the object for the z-sorted arrays
  */
-std::list<Object*>* Crowd::getTagObjects(const std::string & _tag)
+Crowd::Entry Crowd::handle(Object * _object)
 {
-    std::list<Object *> * objects = 0;
-    std::map<std::string, std::list<Object *>*>::iterator objIt = crowd.find(_tag);
-    if (objIt==crowd.end())
+    _object->crowdZIndex    = _object->getZIndex();
+    _object->crowdSequence  = sequence++;
+
+    // THE NEW HANDLE CANCELS THE PREVIOUS WAKE-UPS: THE OBJECT IS UPDATED AT THE NEXT FRAME
+    if (isSleeper(_object)) { schedule(_object, wakeNow); _object->awake = true; }
+    return Entry(_object);
+}
+
+/**
+ * Remove an object from a z-sorted array (or leave a hole during a traversal)
+ * @param _entries is the z-sorted array
+ * @param _object is the object to remove
+ * @return true if the object has been found
+ */
+bool Crowd::remove(Entries & _entries, Object * _object)
+{
+    int index = find(_entries, _object);
+    if (index>=0)
     {
-        // build the new tag list and insert it into the crowd
-        objects = new std::list<splashouilleImpl::Object*>;
-        crowd.insert(std::pair<std::string, std::list<Object *>*>(_tag, objects));
+        if (traversals) { _entries[index].object = 0; holes = true; } else { _entries.erase(_entries.begin()+index); }
+    }
+    return (index>=0);
+}
+
+/**
+ * Remove the holes left in a z-sorted array by the traversals
+ * @param _entries is the z-sorted array
+ */
+void Crowd::compact(Entries & _entries)
+{
+    Entries::iterator last = _entries.begin();
+    for (Entries::iterator it=_entries.begin(); it!=_entries.end(); it++)
+    {
+        if (it->object) { *last = *it; last++; }
+    }
+    _entries.erase(last, _entries.end());
+}
+
+/**
+ * Leave a hole in a z-sorted array for each object which is not in the library anymore
+ * @param _entries is the z-sorted array
+ */
+void Crowd::sweep(Entries & _entries)
+{
+    for (Entries::iterator it=_entries.begin(); it!=_entries.end(); it++)
+    {
+        if (it->object && library.find(it->object->idSymbol)==library.end()) { it->object = 0; holes = true; }
+    }
+}
+
+/**
+ * Place an object in the z-sorted arrays (or in the pending objects during a traversal)
+ * @param _object is the object to place
+ */
+void Crowd::place(Object * _object)
+{
+    Entry entry = handle(_object);
+
+    if (traversals)
+    {
+        pending.push_back(entry);
     }
     else
     {
-        objects = objIt->second;
+        place(objects, entry);
+        if (_object->tagSymbol!=Symbol::empty) { place(tags[_object->tagSymbol], entry); }
+        if (!isSleeper(_object)) { place(containers, entry); }
     }
-    return objects;
 }
 
+/**
+ * Place a batch of objects in the z-sorted arrays (or in the pending objects during a traversal)
+ * @param _batch is the batch, sorted by this method
+ */
+void Crowd::place(Entries & _batch)
+{
+    if (traversals)
+    {
+        pending.insert(pending.end(), _batch.begin(), _batch.end());
+    }
+    else
+    {
+        // ONE SORT OF THE BATCH AND ONE MERGE PASS INSTEAD OF ONE INSERTION BY OBJECT
+        std::sort(_batch.begin(), _batch.end(), &Crowd::before);
+        merge(objects, _batch.begin(), _batch.end());
+
+        // THE CONTAINERS OF THE BATCH ARE ALREADY SORTED
+        tagBatch.clear();
+        for (Entries::const_iterator it=_batch.begin(); it!=_batch.end(); it++)
+        {
+            if (!isSleeper(it->object)) { tagBatch.push_back(*it); }
+        }
+        merge(containers, tagBatch.begin(), tagBatch.end());
+
+        // THE SAME FOR EACH TAG: THE TAGGED OBJECTS ARE SORTED BY TAG FIRST
+        tagBatch.clear();
+        for (Entries::const_iterator it=_batch.begin(); it!=_batch.end(); it++)
+        {
+            if (it->object->tagSymbol!=Symbol::empty) { tagBatch.push_back(*it); }
+        }
+        std::sort(tagBatch.begin(), tagBatch.end(), &Crowd::beforeInTag);
+
+        for (Entries::const_iterator it=tagBatch.begin(); it!=tagBatch.end(); )
+        {
+            Entries::const_iterator last = it;
+            while (last!=tagBatch.end() && last->object->tagSymbol==it->object->tagSymbol) { last++; }
+            merge(tags[it->object->tagSymbol], it, last);
+            it = last;
+        }
+    }
+}
+
+/**
+ * Remove an object from the z-sorted arrays (and from the pending objects)
+ * @param _object is the object to remove
+ */
+void Crowd::remove(Object * _object)
+{
+    if (remove(objects, _object))
+    {
+        TagMap::iterator it = tags.find(_object->tagSymbol);
+        if (it!=tags.end()) { remove(it->second, _object); }
+        if (!isSleeper(_object)) { remove(containers, _object); }
+    }
+    else
+    {
+        // THE PENDING OBJECTS ARE NOT SORTED (THEY EXIST DURING THE TRAVERSALS ONLY)
+        for (Entries::iterator it=pending.begin(); it!=pending.end(); it++)
+        {
+            if (it->object==_object) { it->object = 0; break; }
+        }
+    }
+}
+
+/**
+ * Apply the changes made during the traversals: fill the holes and place the pending objects
+ */
+void Crowd::flush()
+{
+    if (holes)
+    {
+        compact(objects);
+        compact(containers);
+        for (TagMap::iterator it=tags.begin(); it!=tags.end(); )
+        {
+            compact(it->second);
+            if (it->second.empty()) { tags.erase(it++); } else { it++; }
+        }
+        holes = false;
+    }
+
+    if (pending.size())
+    {
+        compact(pending);
+        place(pending);
+        pending.clear();
+    }
+}
+
+/**
+ * Schedule the update of a sleeping object (the previous wake-ups of the object are cancelled)
+ * @param _object is the object
+ * @param _timestamp is the wake-up timestamp
+ */
+void Crowd::schedule(Object * _object, int _timestamp)
+{
+    _object->wakeStamp++;
+    wakes.push_back(Wake(_object, _timestamp));
+    std::push_heap(wakes.begin(), wakes.end(), &Crowd::later);
+}
+
+/**
+ * Check if a wake-up is still valid: the object is still in the crowd with the same handle and the
+ * wake-up has not been cancelled
+ * @param _wake is the wake-up
+ * @return true if the object has to be updated
+ */
+bool Crowd::isScheduled(const Wake & _wake) const
+{
+    // THE OBJECT MAY HAVE BEEN DROPPED: IT IS FOUND BY ITS HANDLE BEFORE BEING DEREFERENCED
+    Entries::const_iterator it = std::lower_bound(objects.begin(), objects.end(), Entry(_wake.zIndex, _wake.sequence), &Crowd::before);
+    return (it!=objects.end() && it->object==_wake.object && it->sequence==_wake.sequence && _wake.object->wakeStamp==_wake.stamp);
+}
+
+/**
+ * Remove the cancelled wake-ups from the queue
+ */
+void Crowd::purge()
+{
+    Wakes::iterator last = wakes.begin();
+    for (Wakes::iterator it=wakes.begin(); it!=wakes.end(); it++)
+    {
+        if (isScheduled(*it)) { *last = *it; last++; }
+    }
+    wakes.erase(last, wakes.end());
+    std::make_heap(wakes.begin(), wakes.end(), &Crowd::later);
+}
+
+/**
+ * Evaluate a due sleeping object (it only changes the object: safe on any thread)
+ * @param _sleeper is the object, filled with the result
+ * @param _timestamp is the current timestamp
+ */
+void Crowd::evaluate(Sleeper & _sleeper, int _timestamp)
+{
+    _sleeper.changed        = _sleeper.object->Object::update(_timestamp);
+    _sleeper.wakeTimestamp  = _sleeper.object->getWakeTimestamp();
+}
+
+/**
+ * Evaluate a range of due sleeping objects: their styles are blended as one batch (safe on any thread)
+ * @param _sleepers are the objects, filled with the results
+ * @param _begin is the first object of the range
+ * @param _end is the end of the range
+ * @param _timestamp is the current timestamp
+ */
+void Crowd::evaluate(Sleepers & _sleepers, int _begin, int _end, int _timestamp)
+{
+    // THE BATCH IS LOCAL TO THE RANGE: THE RANGES ARE EVALUATED ON SEVERAL THREADS
+    Fashion::Batch batch;
+
+    for (int i=_begin; i<_end; i++)
+    {
+        Sleeper & sleeper = _sleepers[i];
+        if ((sleeper.blended = sleeper.object->prepareUpdate(_timestamp))) { batch.add(sleeper.object->fashion); }
+    }
+
+    batch.run();
+
+    for (int i=_begin; i<_end; i++)
+    {
+        Sleeper & sleeper = _sleepers[i];
+        sleeper.changed         = sleeper.object->finishUpdate(sleeper.blended);
+        sleeper.wakeTimestamp   = sleeper.object->getWakeTimestamp();
+    }
+}
+
+/**
+ * Damage the areas of an evaluated object and schedule its next update
+ * @param _sleeper is the evaluated object
+ * @param _timestamp is the current timestamp
+ */
+void Crowd::settle(const Sleeper & _sleeper, int _timestamp)
+{
+    Object * object = _sleeper.object;
+
+    // THE OLD AND NEW POSITIONS ARE DAMAGED SEPARATELY (THEIR UNION IS HUGE FOR FAST MOVERS)
+    if (_sleeper.changed)
+    {
+        animation->addUpdateRect(object->updateArea);
+        animation->addUpdateRect(object->position);
+    }
+
+    object->awake = false;
+    if (_sleeper.wakeTimestamp!=Fashion::never)
+    {
+        schedule(object, _sleeper.wakeTimestamp>_timestamp?_sleeper.wakeTimestamp:_timestamp+1);
+    }
+}
+
+/**
+ * The parallel stage of the update: the evaluation of the due objects
+ */
+class Crowd::Evaluation : public ThreadPool::Task
+{
+private:
+    Sleepers &  sleepers;       // The due objects
+    int         timestamp;      // The current timestamp
+public:
+    Evaluation(Sleepers & _sleepers, int _timestamp):sleepers(_sleepers), timestamp(_timestamp) {}
+    void run(int _begin, int _end) { Crowd::evaluate(sleepers, _begin, _end, timestamp); }
+};
 
 /**
  * Insert an active object into the crowd
@@ -67,36 +422,70 @@ std::list<Object*>* Crowd::getTagObjects(const std::string & _tag)
  * @return true
  */
 bool Crowd::insertObject(int _timestamp, splashouille::Object * _object)
+{
+    return insertObject(_timestamp, _object, 0);
+}
+
+/**
+ * Insert a batch of active objects into the crowd (cheaper than one by one for large batches)
+ * @param _timestamp is the insertion timestamp
+ * @param _objects is the objects list
+ * @return the number of inserted objects
+ */
+int Crowd::insertObjects(int _timestamp, const std::vector<splashouille::Object*> & _objects)
+{
+    int     ret = 0;
+    Entries batch;
+
+    batch.reserve(_objects.size());
+    for (std::vector<splashouille::Object*>::const_iterator it=_objects.begin(); it!=_objects.end(); it++)
+    {
+        if (insertObject(_timestamp, *it, &batch)) { ret++; }
+    }
+
+    // THE CALLBACKS MAY HAVE DROPPED SOME OF THE NEW OBJECTS
+    sweep(batch);
+    compact(batch);
+    place(batch);
+
+    return ret;
+}
+
+/**
+ * Insert an active object into the crowd
+ * @param _timestamp is the insertion timestamp
+ * @param _object is the object
+ * @param _batch is the bulk insertion batch (0 for placing the object now)
+ * @return true if the object has been inserted
+ */
+bool Crowd::insertObject(int _timestamp, splashouille::Object * _object, Entries * _batch)
 {
     Object *                object      = dynamic_cast<Object*>(_object);
 
     // Look the object into the z-indexed list
-    bool        rc = (object && (library.find(object->getId())==library.end()));
+    bool        rc = (object && (library.find(object->idSymbol)==library.end()));
     if (rc)
     {
         if (object->inCrowd(this))
         {
+            // The crowd is woken up by the changes of the object
+            object->container = this;
+
             // Set the object initial timestamp in the crowd
             object->setInitialTimestamp(_timestamp);
 
-            // Insert the object into the list sorted by z-index
-            std::list<Object*> *            objects     = getTagObjects(_object->getTag());
-            std::list<Object*>::iterator    position    = objects->begin();
-            for (std::list<Object*>::iterator it=objects->begin(); it!=objects->end(); it++)
-            {
-                if ( (*it)->getZIndex() <= object->getZIndex() ) { position = it; position++; }
-            }
-            objects->insert(position, object);
+            // Insert the object into the arrays sorted by z-index (or into the batch)
+            if (_batch) { _batch->push_back(handle(object)); } else { place(object); }
 
             // Insert in the general library
-            library.insert(std::pair<std::string, Object*>(object->getId(), object));
+            library.insert(std::pair<int, Object*>(object->idSymbol, object));
         }
 
         // Initialize the object (if has been already in a crowd)
-        dynamic_cast<Fashion*>(object->getFashion())->clear();
+        object->fashion->clear();
 
         // Link the animation with its parent
-        if (object->isAnimation()) { dynamic_cast<Animation*>(object)->setParent(animation); }
+        if (object->kind==Object::kindAnimation) { object->concrete.animation->setParent(animation); }
 
         // Call the callback listener
         if (object->getListener()) { object->getListener()->onShow(_timestamp, object); }
@@ -124,7 +513,7 @@ bool Crowd::insertObject(int _timestamp, splashouille::Object * _object)
  */
 splashouille::Object * Crowd::getObject(const std::string & _id)
 {
-    std::map<std::string, Object*>::iterator it = library.find(_id);
+    ObjectMap::iterator it = library.find(Symbol::find(_id));
     return (it!=library.end())?it->second:0;
 }
 
@@ -135,8 +524,17 @@ splashouille::Object * Crowd::getObject(const std::string & _id)
  */
 splashouille::Object * Crowd::dropObject(const std::string & _id)
 {
-    std::map<std::string, Object*>::iterator it  = library.find(_id);
-    return dropObject(it);
+    return dropObjectBySymbol(Symbol::find(_id));
+}
+
+/**
+ * Remove an object from the crowd (do not delete the instance)
+ * @param _idSymbol is the object to delete as id symbol
+ * @return the instance pointer (0 if deleted failed)
+ */
+splashouille::Object * Crowd::dropObjectBySymbol(int _idSymbol)
+{
+    return dropObject(library.find(_idSymbol));
 }
 
 /**
@@ -146,10 +544,13 @@ splashouille::Object * Crowd::dropObject(const std::string & _id)
  */
 splashouille::Object * Crowd::dropObject(splashouille::Object * _obj)
 {
-    splashouille::Object * ret = 0;
-    for (std::map<std::string, Object* >::iterator it=library.begin(); it!=library.end(); it++)
+    splashouille::Object *  ret     = 0;
+    Object *                object  = dynamic_cast<Object*>(_obj);
+    if (object)
     {
-        if (it->second == _obj) { ret = dropObject(it); break; }
+        // THE ID SYMBOL IS THE KEY OF THE OBJECT IN THE CROWD LIBRARY
+        ObjectMap::iterator it = library.find(object->idSymbol);
+        if (it!=library.end() && it->second==object) { ret = dropObject(it); }
     }
     return ret;
 }
@@ -160,32 +561,25 @@ splashouille::Object * Crowd::dropObject(splashouille::Object * _obj)
  * @param _it is the map iterator
  * @return the instance pointer (0 if deleted failed)
  */
-splashouille::Object * Crowd::dropObject(std::map<std::string, Object *>::iterator _it)
+splashouille::Object * Crowd::dropObject(ObjectMap::iterator _it)
 {
     Object * ret = 0;
     if (_it!=library.end())
     {
         Object *                        object      = _it->second;
-        std::list<Object*> *            objects     = getTagObjects(object->getTag());
-        std::list<Object*>::iterator    position    = objects->end();
 
-        for (std::list<Object*>::iterator it=objects->begin(); it!=objects->end(); it++)
-        {
-            if (_it->second == *it) { position = it; }
-        }
-
-        if (position!=objects->end()) {
-            // Remove the object from the crowd
-            library.erase(_it);
-            objects->erase(position);
+        // Remove the object from the crowd
+        library.erase(_it);
+        remove(object);
+        if (object->container==this) { object->container = 0; }
+        ret = object;
 
-            // Call the callback methods
-            if (object->getListener()) { object->getListener()->onHide(object); }
-            object->outCrowd();
+        // Call the callback methods
+        if (object->getListener()) { object->getListener()->onHide(object); }
+        object->outCrowd();
 
-            // Add an update area in the parent animation
-            animation->addUpdateRect(object->getPosition());
-        }
+        // Add an update area in the parent animation
+        animation->addUpdateRect(object->getPosition());
 
         if (Engine::debug)
         {
@@ -207,28 +601,14 @@ bool Crowd::setZIndex(splashouille::Object * _obj, int _zIndex)
     if (_obj)
     {
         Object *                        object      = dynamic_cast<Object*>(_obj);
-        std::list<Object*> *            objects     = getTagObjects(_obj->getTag());
-        std::list<Object*>::iterator    position    = objects->end();
-
-        for (std::list<Object*>::iterator it=objects->begin(); it!=objects->end(); it++)
-        {
-            if (_obj == *it) { position = it; }
-        }
 
         // If the object is find
-        if (position!=objects->end()) {
-            // Set the new zIndex of the object and remove it from the list
+        if (object && library.find(object->idSymbol)!=library.end()) {
+            // Remove the object from the arrays, set its new zIndex and insert it in its new place
             ret = true;
+            remove(object);
             object->setZIndex(_zIndex);
-            objects->erase(position);
-
-            // Insert the object in the zIndex sorted list in its new place
-            position = objects->begin();
-            for (std::list<Object*>::iterator it=objects->begin(); it!=objects->end(); it++)
-            {
-                if ( (*it)->getZIndex() <= object->getZIndex() ) { position = it; position++; }
-            }
-            objects->insert(position, object);
+            place(object);
         }
     }
     return ret;
@@ -245,6 +625,54 @@ bool Crowd::setZIndex(const std::string & _id, int _zIndex)
     return setZIndex(getObject(_id), _zIndex);
 }
 
+/**
+ * Schedule an object of the crowd for the next update
+ * @param _object is the object
+ */
+void Crowd::wake(Object * _object)
+{
+    if (isSleeper(_object)) { schedule(_object, wakeNow); _object->awake = true; }
+}
+
+/**
+ * Get the next timestamp the crowd changes at: its first wake-up or the next change of its animations
+ * and maps (a cancelled wake-up is counted too: the timestamp may be early but never late)
+ * @return the timestamp (Fashion::never if nothing changes by itself)
+ */
+int Crowd::getWakeTimestamp() const
+{
+    int ret = wakes.empty()?Fashion::never:wakes.front().timestamp;
+
+    for (unsigned int i=0; i<containers.size(); i++)
+    {
+        Object *    object  = containers[i].object;
+        int         wake    = Fashion::never;
+
+        if (object && object->kind==Object::kindAnimation)  { wake = object->concrete.animation->getWakeTimestamp(); }
+        else if (object)                                    { wake = object->Object::getWakeTimestamp(); }
+        if (wake<ret) { ret = wake; }
+    }
+
+    return ret;
+}
+
+/**
+ * Remove a deleted object from the crowd (no callback)
+ * @param _object is the object
+ */
+void Crowd::forget(Object * _object)
+{
+    // THE CONCRETE PART OF THE OBJECT IS ALREADY DESTROYED: ONLY ITS BASE MEMBERS ARE READ
+    ObjectMap::iterator it = library.find(_object->idSymbol);
+    if (it!=library.end() && it->second==_object)
+    {
+        library.erase(it);
+        remove(_object);
+        animation->addUpdateRect(_object->position);
+    }
+    _object->container = 0;
+}
+
 /**
  * Get the crowd size
  * @return the crowd size as int
@@ -261,18 +689,16 @@ int Crowd::getSize()
 void Crowd::log(int _rank) const
 {
     std::string offset; offset.append(4*_rank,' ');
-    std::cout<<offset<<"+ Crowd (size map: "<<library.size()<<") (tags list: "<<crowd.size()<<")"<<std::endl;
+    std::cout<<offset<<"+ Crowd (size map: "<<library.size()<<") (tags list: "<<tags.size()<<")"<<std::endl;
 
-    for (std::map<std::string, std::list<Object*>*>::const_iterator it=crowd.begin(); it!=crowd.end(); it++)
+    int index = 0;
+    for (Entries::const_iterator it=objects.begin(); it!=objects.end(); it++)
     {
-        std::list<Object*> *    objects     = it->second;
-        int                     index       = 0;
-        std::cout<<offset<<"    + Tag: "<<it->first<<" (size: "<< objects->size()<<")"<<std::endl;
-
-        for (std::list<Object*>::const_iterator it=objects->begin(); it!=objects->end(); it++)
+        Object *            object      = it->object;
+        if (object)
         {
-            Object *            object      = (*it);
-            std::cout<<offset<<"    ["<<index<<"] (key: "<<object->getId()<<") (z-index: "<<object->getZIndex()<<")"<<std::endl;
+            std::cout<<offset<<"    ["<<index<<"] (key: "<<object->getId()<<") (tag: "<<object->getTag()
+                     <<") (z-index: "<<object->getZIndex()<<")"<<std::endl;
             object->log(_rank+2);
             index++;
         }
@@ -291,33 +717,29 @@ void Crowd::log(int _rank) const
  */
 bool Crowd::mouseEvent(int _timestampInMilliSeconds, int _x, int _y , bool _checkOver, int _state)
 {
-    class MouseEvent : public Listener
+    bool checkOver = _checkOver;
+
+    // FROM THE CLOSEST TO THE FAREST (THE PENDING OBJECTS ARE VISITED FIRST AS IN forEach)
+    traversals++;
+    int size = objects.size();
+    for (int i=size+pending.size()-1; i>=0; i--)
     {
-    private:
-        int ts, x, y, state;
-    public:
-        bool checkOver;
-        MouseEvent(int _ts, int _x, int _y, bool _checkOver, int _state):
-            ts(_ts),x(_x),y(_y),state(_state), checkOver(_checkOver) {}
-        bool onObject(splashouille::Object * _object, int _user UNUSED)
+        Object * object = (i<size)?objects[i].object:pending[i-size].object;
+        if (!object || object==Engine::mouse) { continue; }
+
+        if (object->kind==Object::kindAnimation)
         {
-            if (_object!=Engine::mouse)
-            {
-                if (_object->isAnimation())
-                {
-                    checkOver &= dynamic_cast<Animation*>(_object)->mouseEvent(ts, x, y, checkOver, state);
-                }
-                else
-                {
-                    checkOver &= dynamic_cast<Object*>(_object)->mouseEvent(ts, x, y, checkOver, state);
-                }
-            }
-            return true;
+            checkOver &= object->concrete.animation->mouseEvent(_timestampInMilliSeconds, _x, _y, checkOver, _state);
         }
-    };
-    MouseEvent mouseEventListener(_timestampInMilliSeconds, _x, _y, _checkOver, _state);
-    forEach(&mouseEventListener, "", false);
-    return mouseEventListener.checkOver;
+        else
+        {
+            checkOver &= object->mouseEvent(_timestampInMilliSeconds, _x, _y, checkOver, _state);
+        }
+    }
+    traversals--;
+    if (!traversals) { flush(); }
+
+    return checkOver;
 }
 
 /**
@@ -328,100 +750,132 @@ bool Crowd::mouseEvent(int _timestampInMilliSeconds, int _x, int _y , bool _chec
  */
 void Crowd::forEach(Listener * _listener, const std::string & _tag, bool _ascendant, int _user) const
 {
-    bool rc = true;
-    if (_tag.size())
+    // AN UNKNOWN TAG HAS NO OBJECT
+    int tagSymbol = Symbol::find(_tag);
+    if (tagSymbol!=Symbol::none) { forEach(_listener, tagSymbol, _ascendant, _user); }
+}
+
+/**
+ * Parse the crowd
+ * @param _listener is the callback listener
+ * @param _tagSymbol is the requested tag object as symbol (all objects if Symbol::empty)
+ * @param _ascendant is true for an z-index ascendant browsing (from farest to closest)
+ * @param _user is a user parameter forwarded to the callback
+ */
+void Crowd::forEach(Listener * _listener, int _tagSymbol, bool _ascendant, int _user) const
+{
+    const Entries * entries = &objects;
+    if (_tagSymbol!=Symbol::empty)
+    {
+        TagMap::const_iterator it = tags.find(_tagSymbol);
+        entries = (it!=tags.end())?&it->second:0;
+    }
+
+    // THE ARRAYS DO NOT MOVE DURING THE TRAVERSAL: THE CHANGES ARE DELAYED (HOLES AND PENDING OBJECTS).
+    // THE PENDING OBJECTS (INSERTED DURING A RUNNING TRAVERSAL) ARE VISITED AFTER THE SORTED ONES
+    int     size    = entries?entries->size():0;
+    bool    rc      = true;
+
+    traversals++;
+    if (_ascendant)
     {
-        // THE EASY CASE: PARSE ONE TAGGED LIST REGARDING THE ORDER (ASCENDANT OR DESCENDANT)
-        std::map<std::string, std::list<Object*>*>::const_iterator it = crowd.find(_tag);
-        if (it!=crowd.end())
+        for (int i=0; rc && i<size; i++)
         {
-            std::list<Object*> * objects     = it->second;
-            if (_ascendant)
-            {
-                for (std::list<Object*>::const_iterator it=objects->begin(); rc && it!=objects->end(); it++)
-                {
-                    rc = _listener->onObject(*it, _user);
-                }
-            }
-            else
-            {
-                for (std::list<Object*>::const_iterator it=objects->end(); rc && it!=objects->begin(); it--)
-                {
-                    std::list<Object*>::const_iterator prevIt = it;
-                    prevIt--;
-                    rc = _listener->onObject(*prevIt, _user);
-                }
-            }
+            Object * object = (*entries)[i].object;
+            if (object) { rc = _listener->onObject(object, _user); }
+        }
+        for (unsigned int i=0; rc && i<pending.size(); i++)
+        {
+            Object * object = pending[i].object;
+            if (object && (_tagSymbol==Symbol::empty || object->tagSymbol==_tagSymbol)) { rc = _listener->onObject(object, _user); }
         }
     }
     else
     {
-        // MERGE AND PARSE THE DIFFERENT TAGGED LISTS REGARDING THE Z-INDEX OF THEIR FIRST ELEMENT
-
-        // FILL THE TAGS LIST BY ZINDEX ORDER
-        std::list<objectParser>     tags;
-        for (std::map<std::string, std::list<Object*>*>::const_iterator it=crowd.begin(); it!=crowd.end(); it++)
+        for (int i=pending.size()-1; rc && i>=0; i--)
         {
-            // SKIP THE EMPTY LIST
-            if (it->second->begin()!=it->second->end())
-            {
-                // GET THE FIRST OBJECT OF THE TAGGED LIST
-                objectIterator tag = it->second->begin();
-                if (!_ascendant) { tag = it->second->end(); tag--; }
-
-                // GET THE LAST OBJECT OF THE TAGGED LIST
-                objectIterator lastTag = it->second->begin();
-                if (_ascendant) { lastTag = it->second->end(); lastTag--; }
-
-                // PLACE THE FIRST OBJECT IN THE PARSING LIST REGARDING ITS Z-INDEX
-                std::list<objectParser>::iterator   position    = tags.begin();
-                for (std::list<objectParser>::iterator itTag = tags.begin(); itTag!=tags.end(); itTag++)
-                {
-                    if ( CMP( (*((*itTag).first))->getZIndex(),(*tag)->getZIndex(), _ascendant) ) { position = itTag; position++; }
-                }
-                tags.insert(position, objectParser(tag, lastTag));
-            }
+            Object * object = pending[i].object;
+            if (object && (_tagSymbol==Symbol::empty || object->tagSymbol==_tagSymbol)) { rc = _listener->onObject(object, _user); }
         }
-
-        // PARSE THE TAGS LIST
-        while (rc && tags.size())
+        for (int i=size-1; rc && i>=0; i--)
         {
-            // THE CURRENT Z-INDEX IS (*((*tags.begin()).first))->getZIndex(), GET THE NEXT ONE FROM ANOTHER TAG LIST
-            std::list<objectParser>::iterator   position    = tags.begin();
-            int nextZIndex = _ascendant?std::numeric_limits<int>::max():std::numeric_limits<int>::min();
-            if (tags.size()>1)
-            {
-                position++;
-                nextZIndex = (*((*position).first))->getZIndex();
-            }
+            Object * object = (*entries)[i].object;
+            if (object) { rc = _listener->onObject(object, _user); }
+        }
+    }
+    traversals--;
 
-            // TREAT EVERY OBJECT OF THE CURRENT TAG LIST UNTIL IT REACHES THE NEXT Z-INDEX
-            bool tagNotEmpty = true;
-            while ( rc && tagNotEmpty && CMP((*((*tags.begin()).first))->getZIndex(),nextZIndex,_ascendant) )
-            {
-                if ( (rc = _listener->onObject(*((*tags.begin()).first), _user)))
-                {
-                    if ((*tags.begin()).first==(*tags.begin()).second)  { tagNotEmpty = false; }
-                    else {
-                        if (_ascendant) { (*tags.begin()).first++; } else { (*tags.begin()).first--; }
-                    }
-                }
-            }
+    if (!traversals) { const_cast<Crowd*>(this)->flush(); }
+}
 
-            // IF THE CURRENT TAG LIST IS NOT ENDED, INSERT IT IN THE PARSING LIST REGARDING THE CURRENT Z_INDEX
-            if (rc)
-            {
-                if (tagNotEmpty)
-                {
-                    for (std::list<objectParser>::iterator itTag = tags.begin(); itTag!=tags.end(); itTag++)
-                    {
-                        if ( CMP((*((*itTag).first))->getZIndex(),nextZIndex,_ascendant) ) { position = itTag; position++; }
-                    }
-                    tags.insert(position, *tags.begin());
-                }
-                tags.erase(tags.begin());
-            }
-        };
+/**
+ * Update an object regarding its concrete kind (no virtual call)
+ * @param _object is the object to update
+ * @param _timestamp is the current timestamp
+ * @return true if the object has changed
+ */
+static bool updateObject(Object * _object, int _timestamp)
+{
+    switch (_object->kind)
+    {
+    case Object::kindAnimation:     return _object->concrete.animation->Animation::update(_timestamp);
+    case Object::kindMap:           return _object->concrete.map->Map::update(_timestamp);
+    default:                        return _object->Object::update(_timestamp);
+    }
+}
+
+/**
+ * Render an object regarding its concrete kind (no virtual call)
+ * @param _object is the object to render
+ * @param _surface is the surface to fill
+ * @param _offset is the parent offset
+ * @return true
+ */
+static bool renderObject(Object * _object, SDL_Surface * _surface, SDL_Rect * _offset)
+{
+    switch (_object->kind)
+    {
+    case Object::kindSolid:         return _object->concrete.solid->Solid::render(_surface, _offset);
+    case Object::kindImage:         return _object->concrete.image->Image::render(_surface, _offset);
+    case Object::kindAnimation:     return _object->concrete.animation->Animation::render(_surface, _offset);
+    case Object::kindSound:         return _object->concrete.sound->Sound::render(_surface, _offset);
+    default:                        return true;
+    }
+}
+
+/**
+ * Prepare the render of an object regarding its concrete kind (no virtual call)
+ * @param _object is the object to render
+ * @param _surface is the surface to fill
+ * @param _offset is the parent offset
+ * @param _command is the blit command (output)
+ * @return true if there is something to blit
+ */
+static bool compileObject(Object * _object, SDL_Surface * _surface, SDL_Rect * _offset, DisplayList::Command * _command)
+{
+    switch (_object->kind)
+    {
+    case Object::kindSolid:         return _object->concrete.solid->Solid::compile(_surface, _offset, _command);
+    case Object::kindImage:         return _object->concrete.image->Image::compile(_surface, _offset, _command);
+    case Object::kindAnimation:     return _object->concrete.animation->Animation::compile(_surface, _offset, _command);
+    default:                        return false;
+    }
+}
+
+/**
+ * Get the opaque area of an object regarding its concrete kind (no virtual call)
+ * @param _object is the object
+ * @param _rect is the opaque area in the parent coordinates (output)
+ * @return true if the object is opaque on a not empty area
+ */
+static bool getOpaqueRect(Object * _object, SDL_Rect * _rect)
+{
+    switch (_object->kind)
+    {
+    case Object::kindSolid:         return _object->concrete.solid->Solid::getOpaqueRect(_rect);
+    case Object::kindImage:         return _object->concrete.image->Image::getOpaqueRect(_rect);
+    case Object::kindAnimation:     return _object->concrete.animation->Animation::getOpaqueRect(_rect);
+    default:                        return false;
     }
 }
 
@@ -432,101 +886,405 @@ void Crowd::forEach(Listener * _listener, const std::string & _tag, bool _ascend
  */
 void Crowd::update( int _timestamp)
 {
-    for (std::map<std::string, Object *>::iterator it = library.begin(); it!=library.end(); it++)
+    traversals++;
+
+    // THE ANIMATIONS AND THE MAPS RUN THEIR OWN CROWD, TIMELINE OR TILES: THEY ARE UPDATED AT EACH FRAME
+    for (unsigned int i=0; i<containers.size(); i++)
+    {
+        Object * object = containers[i].object;
+
+        // THE OLD AND NEW POSITIONS ARE DAMAGED SEPARATELY (THEIR UNION IS HUGE FOR FAST MOVERS)
+        if (object && updateObject(object, _timestamp))
+        {
+            animation->addUpdateRect(object->updateArea);
+            animation->addUpdateRect(object->position);
+        }
+    }
+
+    // THE OTHER OBJECTS SLEEP UNTIL THEIR NEXT TRANSITION BOUNDARY OR UNTIL A CHANGE WAKES THEM UP
+    if (wakes.size()>2*library.size()+nbWakesMin) { purge(); }
+    sleepers.clear();
+    while (!wakes.empty() && wakes.front().timestamp<=_timestamp)
     {
-        if ((it->second)->update(_timestamp)) { animation->addUpdateRect((it->second)->getUpdateRect()); }
+        Wake wake = wakes.front();
+        std::pop_heap(wakes.begin(), wakes.end(), &Crowd::later);
+        wakes.pop_back();
+
+        // A DUE OBJECT STAYS AWAKE UNTIL IT IS SETTLED: THE CHANGES OF ITS OWN UPDATE DO NOT WAKE IT UP AGAIN
+        if (isScheduled(wake)) { wake.object->awake = true; sleepers.push_back(Sleeper(wake.object)); }
     }
+
+    // THE DUE OBJECTS ARE EVALUATED IN PARALLEL, THEN SETTLED IN THE QUEUE ORDER (SAME RESULT AS SERIAL)
+    Evaluation evaluation(sleepers, _timestamp);
+    ThreadPool::run(&evaluation, sleepers.size(), sleepersGrain);
+    for (unsigned int i=0; i<sleepers.size(); i++) { settle(sleepers[i], _timestamp); }
+
+    // THE OBJECTS INSERTED DURING THE UPDATE (BY THE MAPS FOR EXAMPLE) ARE UPDATED TOO
+    for (unsigned int i=0; i<pending.size(); i++)
+    {
+        Object * object = pending[i].object;
+
+        if (object && isSleeper(object))            { Sleeper sleeper(object); evaluate(sleeper, _timestamp); settle(sleeper, _timestamp); }
+        else if (object && updateObject(object, _timestamp))
+        {
+            animation->addUpdateRect(object->updateArea);
+            animation->addUpdateRect(object->position);
+        }
+    }
+
+    traversals--;
+    if (!traversals) { flush(); }
 }
 
 /**
- * Render the current crowd
+ * Get the area covered by a rect in the surface coordinates (clipped by the parent offset and the surface)
+ * @param _rect is the rect in the parent coordinates
+ * @param _offset is the parent offset (if any)
+ * @param _surface is the rendering surface
+ * @param _area is the covered area (output)
+ * @return true if the area is not empty
+ */
+static bool getArea(const SDL_Rect * _rect, const SDL_Rect * _offset, const SDL_Surface * _surface, SDL_Rect * _area)
+{
+    int x0 = _rect->x, y0 = _rect->y, x1 = _rect->x+_rect->w, y1 = _rect->y+_rect->h;
+    int cx0 = 0, cy0 = 0, cx1 = _surface->w, cy1 = _surface->h;
+
+    if (_offset)
+    {
+        x0 += _offset->x; x1 += _offset->x; y0 += _offset->y; y1 += _offset->y;
+        if (_offset->x>cx0)             { cx0 = _offset->x; }
+        if (_offset->y>cy0)             { cy0 = _offset->y; }
+        if (_offset->x+_offset->w<cx1)  { cx1 = _offset->x+_offset->w; }
+        if (_offset->y+_offset->h<cy1)  { cy1 = _offset->y+_offset->h; }
+    }
+
+    if (x0<cx0) { x0 = cx0; }
+    if (y0<cy0) { y0 = cy0; }
+    if (x1>cx1) { x1 = cx1; }
+    if (y1>cy1) { y1 = cy1; }
+
+    bool ret = (x0<x1 && y0<y1);
+    if (ret) { _area->x = x0; _area->y = y0; _area->w = x1-x0; _area->h = y1-y0; }
+    return ret;
+}
+/**
+ * Get the intersection of two rects
+ * @param _a is the first rect
+ * @param _b is the second rect
+ * @param _inter is the intersection (output)
+ * @return true if the intersection is not empty
+ */
+static bool intersect(const SDL_Rect * _a, const SDL_Rect * _b, SDL_Rect * _inter)
+{
+    int x0 = _a->x>_b->x?_a->x:_b->x;
+    int y0 = _a->y>_b->y?_a->y:_b->y;
+    int x1 = _a->x+_a->w<_b->x+_b->w?_a->x+_a->w:_b->x+_b->w;
+    int y1 = _a->y+_a->h<_b->y+_b->h?_a->y+_a->h:_b->y+_b->h;
+
+    bool ret = (x0<x1 && y0<y1);
+    if (ret) { _inter->x = x0; _inter->y = y0; _inter->w = x1-x0; _inter->h = y1-y0; }
+    return ret;
+}
+/**
+ * Check if a rect is inside another one
+ * @param _outer is the covering rect
+ * @param _inner is the covered rect
+ * @return true if _inner is inside _outer
+ */
+static bool contains(const SDL_Rect * _outer, const SDL_Rect * _inner)
+{
+    return _inner->x>=_outer->x && _inner->y>=_outer->y &&
+           _inner->x+_inner->w<=_outer->x+_outer->w && _inner->y+_inner->h<=_outer->y+_outer->h;
+}
+/**
+ * Prepare the next render: browse the crowd from the front to the back and mark the objects
+ * fully covered by an opaque object above them
  * @param _surface is the surface to render
  * @param _offset is the parent offset
  */
-void Crowd::render(SDL_Surface * _surface, SDL_Rect * _offset)
+void Crowd::occlude(SDL_Surface * _surface, SDL_Rect * _offset)
 {
-    class Render : public Listener
+    occluders.clear();
+    hidden.assign(objects.size(), 0);
+    nbOccluders.assign(objects.size(), 0);
+
+    // FROM THE FRONT TO THE BACK: AN OBJECT IS HIDDEN IF ITS WHOLE AREA IS INSIDE AN OPAQUE AREA IN FRONT OF IT.
+    // THE SOUNDS ARE ALWAYS RENDERED (THE VOLUME IS SET DURING THE RENDER)
+    for (int i=objects.size()-1; i>=0; i--)
     {
-        private :
-            SDL_Surface *   surface;
-            SDL_Rect *      offset;
-        public:
-        Render(SDL_Surface * _surface, SDL_Rect * _offset):surface(_surface), offset(_offset) {}
-        bool onObject(splashouille::Object * _object, int _user UNUSED)
+        Object *    object  = objects[i].object;
+        SDL_Rect    area;
+
+        nbOccluders[i] = occluders.size();
+        if (!object || object->kind==Object::kindSound || !getArea(object->position, _offset, _surface, &area)) { continue; }
+
+        for (std::vector<SDL_Rect>::const_iterator it=occluders.begin(); !hidden[i] && it!=occluders.end(); it++)
         {
-            dynamic_cast<Object*>(_object)->render(surface, offset);
-            return true;
+            if (contains(&(*it), &area)) { hidden[i] = 1; }
         }
-    };
-    Render  renderListener(_surface, _offset);
-    forEach(&renderListener);
+
+        // A HIDDEN OBJECT IS INSIDE AN EXISTING OCCLUDER, NO NEED TO CHECK IF IT IS OPAQUE
+        if (!hidden[i] && static_cast<int>(occluders.size())<nbOccludersMax &&
+            getOpaqueRect(object, &area) && getArea(&area, _offset, _surface, &area))
+        {
+            occluders.push_back(area);
+        }
+    }
+
+    occlusionReady = true;
+}
+
+/**
+ * Check if an area will be fully covered by an opaque object during the next render
+ * @param _rect is the area in the surface coordinates
+ * @return true if the area is covered
+ */
+bool Crowd::isOccluded(const SDL_Rect * _rect) const
+{
+    bool ret = false;
+    for (std::vector<SDL_Rect>::const_iterator it=occluders.begin(); occlusionReady && !ret && it!=occluders.end(); it++)
+    {
+        ret = contains(&(*it), _rect);
+    }
+    return ret;
 }
 
+/**
+ * Find the parts of an object to render: its area in the update rects of the surface owner,
+ * without the parts covered by an opaque object in front of it
+ * @param _index is the object index in the z-sorted array
+ * @param _owner is the surface owner
+ * @param _surface is the surface to render
+ * @param _offset is the parent offset
+ * @return the number of parts (in clips), -1 if the object is hidden or outside the damaged region
+ */
+int Crowd::findClips(unsigned int _index, Animation * _owner, SDL_Surface * _surface, SDL_Rect * _offset)
+{
+    const SDL_Rect *    rects   = _owner->getUpdateRects();
+    SDL_Rect            area;
+
+    // SKIP THE OCCLUDED OBJECTS AND THE OBJECTS OUTSIDE THE DAMAGED REGION (SPATIAL INDEX OF THE OWNER REGION)
+    rectIndices.clear();
+    clips.clear();
+    if (hidden[_index] || !getArea(objects[_index].object->position, _offset, _surface, &area) ||
+        !_owner->findUpdateRects(&area, rectIndices))
+    {
+        return -1;
+    }
+
+    // ONE PART PER UPDATE RECT UNLESS IT IS COVERED BY AN OPAQUE OBJECT IN FRONT OF THE OBJECT
+    for (std::vector<int>::const_iterator it=rectIndices.begin(); it!=rectIndices.end(); it++)
+    {
+        SDL_Rect    clip;
+        bool        covered = false;
+        if (!intersect(&rects[*it], &area, &clip)) { continue; }
+
+        for (int j=0; !covered && j<nbOccluders[_index]; j++) { covered = contains(&occluders[j], &clip); }
+
+        if (!covered) { clips.push_back(clip); }
+    }
+
+    return clips.size();
+}
 
 /**
- * Clear the crowd
+ * Collect the surfaces read by the render of the crowd (recursively) for an offscreen animation
+ * @param _sources is the offscreen animation of each surface (updated)
+ * @param _subtree is the offscreen animation index
+ * @param _dependent is set for the offscreen animations which cannot be rendered in parallel (updated)
  */
-void Crowd::clear(const std::string & _tag)
+void Crowd::collectSources(SourceMap & _sources, int _subtree, std::vector<char> & _dependent) const
 {
-    if (_tag.size())
+    for (unsigned int i=0; !_dependent[_subtree] && i<objects.size(); i++)
     {
-        // REMOVE JUST ONE TAG
-        std::map<std::string, std::list<Object*>*>::iterator itTag = crowd.find(_tag);
-        if (itTag!=crowd.end())
+        Object * object = objects[i].object;
+        if (!object) { continue; }
+
+        // THE SOUNDS SET THE MIXER VOLUME, THE SOLIDS MAY BUILD THEIR SURFACE FROM THE VIDEO FORMAT
+        if (object->kind==Object::kindSound ||
+            (object->kind==Object::kindSolid && (!object->surface || object->surface->w<object->position->w ||
+                                                 object->surface->h<object->position->h)))
         {
-            std::list<Object*> *                        objects     = itTag->second;
-            std::map<std::string, Object *>::iterator   itMap;
+            _dependent[_subtree] = 1;
+        }
 
-            for (std::list<Object*>::iterator it=objects->begin(); it!=objects->end(); )
+        // A SURFACE BLITTED BY TWO OFFSCREEN ANIMATIONS (THE IMAGES SHARE THEIR FILE) SERIALIZES BOTH
+        if (object->surface)
+        {
+            std::pair<SourceMap::iterator, bool> source = _sources.insert(std::make_pair(object->surface, _subtree));
+            if (!source.second && source.first->second!=_subtree)
             {
-                // UPDATE THE DROPED OBJECT
-                if ((*it)->getListener()) { (*it)->getListener()->onHide(*it); }
-                (*it)->outCrowd();
-                animation->addUpdateRect((*it)->getPosition());
-
-                // REMOVE FROM THE LOCAL LIBRARY
-                itMap = library.find((*it)->getId());
-                if (itMap!=library.end())
-                {
-                    library.erase(itMap);
-                }
-                else
-                {
-                    std::cout<<std::setw(STD_LABEL)<<std::left<<"Crowd::clear"<<" Error on library"<<std::endl;
-                }
-
-                // REMOVE FROM THE Z-INDEXED LIST
-                it = objects->erase(it);
+                _dependent[_subtree] = 1;
+                _dependent[source.first->second] = 1;
             }
-            // REMOVE THE TAG LIST
-            crowd.erase(itTag);
-            delete objects;
+        }
+
+        if (object->kind==Object::kindAnimation)
+        {
+            static_cast<const Crowd*>(object->concrete.animation->getCrowd())->collectSources(_sources, _subtree, _dependent);
         }
     }
-    else
+}
+
+/**
+ * The parallel stage of the render: the offscreen animations
+ */
+class Crowd::Offscreen : public ThreadPool::Task
+{
+private:
+    std::vector<Object*> &  subtrees;   // The offscreen animations
+public:
+    Offscreen(std::vector<Object*> & _subtrees):subtrees(_subtrees) {}
+    void run(int _begin, int _end)
     {
-        // REMOVE EVERYTHING: THE QUICK WAY - DELETE OBJECTS FROM THE LIBRARY
-        for (std::map<std::string, Object *>::iterator it = library.begin(); it!=library.end(); it++)
+        for (int i=_begin; i<_end; i++) { subtrees[i]->concrete.animation->Animation::renderSurface(); }
+    }
+};
+
+/**
+ * Render in parallel the damaged offscreen animations of the crowd which share no source surface
+ * (they are then just blitted by the render)
+ * @param _surface is the surface to render
+ * @param _offset is the parent offset
+ */
+void Crowd::renderSubtrees(SDL_Surface * _surface, SDL_Rect * _offset)
+{
+    Animation * owner = animation->getOwner();
+
+    // THE CANDIDATES ARE THE DAMAGED OFFSCREEN ANIMATIONS WHICH WILL BE BLITTED BY THE RENDER
+    subtrees.clear();
+    for (unsigned int i=0; i<objects.size(); i++)
+    {
+        Object * object = objects[i].object;
+        if (object && object->kind==Object::kindAnimation && !object->concrete.animation->isStatic() &&
+            object->concrete.animation->isDamaged() && findClips(i, owner, _surface, _offset)>0)
         {
-            // UPDATE THE DROPED OBJECT
-            if ((it->second)->getListener()) { (it->second)->getListener()->onHide((it->second)); }
-            (it->second)->outCrowd();
-            animation->addUpdateRect((it->second)->getPosition());
+            subtrees.push_back(object);
+        }
+    }
+
+    if (subtrees.size()>1)
+    {
+        // THE SURFACES ARE BUILT BY THE CALLING THREAD, THEN THE OFFSCREEN ANIMATIONS MUST BE INDEPENDENT
+        SourceMap           sources;
+        std::vector<char>   dependent(subtrees.size(), 0);
+        for (unsigned int i=0; i<subtrees.size(); i++)
+        {
+            subtrees[i]->concrete.animation->Animation::prepareSurface(_surface);
+            static_cast<Crowd*>(subtrees[i]->concrete.animation->getCrowd())->collectSources(sources, i, dependent);
+        }
+
+        // THE DEPENDENT ONES ARE RENDERED BY THE RENDER AS USUAL
+        unsigned int nbSubtrees = 0;
+        for (unsigned int i=0; i<subtrees.size(); i++) { if (!dependent[i]) { subtrees[nbSubtrees++] = subtrees[i]; } }
+        subtrees.resize(nbSubtrees);
+
+        if (subtrees.size()>1)
+        {
+            Offscreen offscreen(subtrees);
+            ThreadPool::run(&offscreen, subtrees.size(), 1);
+        }
+    }
+}
+
+/**
+ * Render the current crowd: each object is prepared once and gives one blit command per update rect
+ * of the surface owner it intersects (clipped to this rect), the display list is then executed.
+ * The offscreen animations may be rendered in parallel first, the blits stay in the z-order
+ * @param _surface is the surface to render
+ * @param _offset is the parent offset
+ */
+void Crowd::render(SDL_Surface * _surface, SDL_Rect * _offset)
+{
+    if (!occlusionReady) { occlude(_surface, _offset); }
+
+    Animation * owner = animation->getOwner();
+
+    // THE NESTED OFFSCREEN ANIMATIONS ARE RENDERED BY THE THREAD OF THEIR ANCESTOR
+    if (ThreadPool::getNbThreads()>1 && !ThreadPool::isRunning()) { renderSubtrees(_surface, _offset); }
+
+    for (unsigned int i=0; i<objects.size(); i++)
+    {
+        Object * object = objects[i].object;
+
+        if (!object) { continue; }
+
+        // THE SOUNDS AND THE MAPS DO NOT BLIT ANYTHING (THE SOUND VOLUME IS SET DURING THE RENDER)
+        if (object->kind==Object::kindSound || object->kind==Object::kindMap) { renderObject(object, _surface, _offset); continue; }
+
+        if (findClips(i, owner, _surface, _offset)<0) { continue; }
+
+        // THE STATIC ANIMATIONS RENDER THEIR OWN CROWD DIRECTLY IN THE SURFACE, ABOVE THE PREVIOUS COMMANDS
+        if (object->kind==Object::kindAnimation && object->concrete.animation->isStatic())
+        {
+            displayList.execute(_surface);
+            renderObject(object, _surface, _offset);
+            continue;
         }
-        library.clear();
 
-        // REMOVE EVERY TAGGED Z-INDEXED LISTS
-        for (std::map<std::string, std::list<Object*>*>::iterator it = crowd.begin(); it!=crowd.end(); it++)
+        // ONE COMMAND PER VISIBLE PART (THE OBJECT IS PREPARED ONLY ONCE, ON ITS FIRST VISIBLE PART)
+        DisplayList::Command    command;
+        int                     compiled = 0;
+        for (std::vector<SDL_Rect>::const_iterator it=clips.begin(); compiled>=0 && it!=clips.end(); it++)
         {
-            delete it->second;
+            if (!compiled) { compiled = compileObject(object, _surface, _offset, &command)?1:-1; }
+            if (compiled>0) { displayList.push(command, &(*it)); }
         }
-        crowd.clear();
+    }
+
+    displayList.execute(_surface);
+    occlusionReady = false;
+}
+
+
+/**
+ * Clear the crowd
+ */
+void Crowd::clear(const std::string & _tag)
+{
+    // THE CALLBACKS MAY DROP OTHER OBJECTS (THE MAPS TILES): THE ARRAYS ARE TRAVERSED
+    TagMap::iterator    itTag   = tags.find(Symbol::find(_tag));
+    Entries *           entries = _tag.size()?(itTag!=tags.end()?&itTag->second:0):&objects;
+
+    if (entries)
+    {
+        traversals++;
+        for (unsigned int i=0; i<entries->size()+(_tag.size()?0:pending.size()); i++)
+        {
+            Object * object = (i<entries->size())?(*entries)[i].object:pending[i-entries->size()].object;
+            if (!object) { continue; }
+
+            // UPDATE THE DROPED OBJECT
+            if (object->getListener()) { object->getListener()->onHide(object); }
+            object->outCrowd();
+            animation->addUpdateRect(object->getPosition());
+
+            // REMOVE FROM THE LOCAL LIBRARY
+            ObjectMap::iterator itMap = library.find(object->idSymbol);
+            if (itMap!=library.end())
+            {
+                library.erase(itMap);
+                if (object->container==this) { object->container = 0; }
+            }
+            else
+            {
+                std::cout<<std::setw(STD_LABEL)<<std::left<<"Crowd::clear"<<" Error on library"<<std::endl;
+            }
+        }
+
+        // REMOVE THE DROPPED OBJECTS FROM THE Z-INDEXED ARRAYS IN ONE PASS
+        sweep(objects);
+        sweep(pending);
+        sweep(containers);
+        for (TagMap::iterator it=tags.begin(); it!=tags.end(); it++) { sweep(it->second); }
+        traversals--;
+        if (!traversals) { flush(); }
     }
 
     if (Engine::debug)
     {
         std::cout<<std::setw(STD_LABEL)<<std::left<<"Crowd::clear"<<" (animation: "<<animation->getId()<<
-            ") (tag: "<<_tag<<") (size map: "<<library.size()<<") (tags list: "<<crowd.size()<<")"<<std::endl;
+            ") (tag: "<<_tag<<") (size map: "<<library.size()<<") (tags list: "<<tags.size()<<")"<<std::endl;
     }
 }
 
@@ -538,25 +1296,33 @@ void Crowd::clear(const std::string & _tag)
  */
 void Crowd::changeFashion(const std::string & _fashionId, const std::string & _tag)
 {
-    if (_tag.size())
-    {
-        std::map<std::string, std::list<Object*>*>::iterator itTag = crowd.find(_tag);
-        if (itTag!=crowd.end())
-        {
-            std::list<Object*> *                        objects     = itTag->second;
-            for (std::list<Object*>::iterator it=objects->begin(); it!=objects->end(); it++)
-            {
-                (*it)->changeFashion(_fashionId);
-            }
-        }
-    }
-    else
+    // NO OBJECT HAS AN UNKNOWN FASHION OR TAG
+    int fashionSymbol   = Symbol::find(_fashionId);
+    int tagSymbol       = Symbol::find(_tag);
+    if (fashionSymbol!=Symbol::none && tagSymbol!=Symbol::none) { changeFashion(fashionSymbol, tagSymbol); }
+}
+
+/**
+ * Change the current fashion
+ * @param _fashionSymbol is the fashion Id as symbol
+ * @param _tagSymbol is the requested tag object as symbol (all objects if Symbol::empty)
+ */
+void Crowd::changeFashion(int _fashionSymbol, int _tagSymbol)
+{
+    class ChangeFashion : public Listener
     {
-        for (std::map<std::string, Object *>::iterator it = library.begin(); it!=library.end(); it++)
+        private :
+            int fashionSymbol;
+        public:
+        ChangeFashion(int _fashionSymbol):fashionSymbol(_fashionSymbol) {}
+        bool onObject(splashouille::Object * _object, int _user UNUSED)
         {
-            (it->second)->changeFashion(_fashionId);
+            dynamic_cast<Object*>(_object)->changeFashion(fashionSymbol);
+            return true;
         }
-    }
+    };
+    ChangeFashion changeFashionListener(_fashionSymbol);
+    forEach(&changeFashionListener, _tagSymbol);
 }
 
 
@@ -566,11 +1332,17 @@ void Crowd::changeFashion(const std::string & _fashionId, const std::string & _t
  */
 bool Crowd::outCrowd()
 {
-    for (std::map<std::string, Object *>::iterator it = library.begin(); it!=library.end(); it++)
+    class OutCrowd : public Listener
     {
-        (it->second)->outCrowd();
-    }
+        public:
+        bool onObject(splashouille::Object * _object, int _user UNUSED)
+        {
+            dynamic_cast<Object*>(_object)->outCrowd();
+            return true;
+        }
+    };
+    OutCrowd outCrowdListener;
+    forEach(&outCrowdListener, Symbol::empty);
 
     return true;
 }
-
@@ -0,0 +1,304 @@
+/*
+Copyright 2011 JohannC
+
+This file is part of SPLASHOUILLE.
+
+SPLASHOUILLE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+SPLASHOUILLE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+SPLASHOUILLE.  If not, see http://www.gnu.org/licenses/
+*/
+
+#include <splashouilleImpl/DisplayList.hpp>
+#include <splashouilleImpl/Engine.hpp>
+#include <splashouilleImpl/ThreadPool.hpp>
+#include <cstring>
+
+using namespace splashouilleImpl;
+
+/**
+ * Add a command
+ * @param _command is the blit command
+ * @param _clip is the destination clip rect
+ */
+void DisplayList::push(const Command & _command, const SDL_Rect * _clip)
+{
+    if (nbCommands>=static_cast<int>(commands.size())) { commands.resize(nbCommands+1); }
+
+    commands[nbCommands]        = _command;
+    commands[nbCommands].clip   = *_clip;
+    nbCommands++;
+}
+
+/**
+ * The parallel stage of the execution: the rasterization of the screen tiles
+ */
+class DisplayList::Raster : public ThreadPool::Task
+{
+private:
+    DisplayList &   list;           // The display list (binned)
+    SDL_Surface *   surface;        // The destination surface
+    int             nbColumns;      // The number of tiles per row
+public:
+    Raster(DisplayList & _list, SDL_Surface * _surface, int _nbColumns):list(_list), surface(_surface), nbColumns(_nbColumns) {}
+
+    void run(int _begin, int _end)
+    {
+        for (int b=_begin; b<_end; b++)
+        {
+            Bin &   bin     = list.bins[b];
+            int     x0      = (b%nbColumns)*binSize;
+            int     y0      = (b/nbColumns)*binSize;
+
+            for (int k=bin.first; k<list.bins[b+1].first; k++)
+            {
+                const Command & command = list.commands[list.binned[k]];
+
+                // THE PART OF THE COMMAND CLIP IN THE TILE
+                SDL_Rect    piece;
+                int         x1 = command.clip.x+command.clip.w<x0+binSize?command.clip.x+command.clip.w:x0+binSize;
+                int         y1 = command.clip.y+command.clip.h<y0+binSize?command.clip.y+command.clip.h:y0+binSize;
+                piece.x = command.clip.x>x0?command.clip.x:x0;
+                piece.y = command.clip.y>y0?command.clip.y:y0;
+                piece.w = x1-piece.x;
+                piece.h = y1-piece.y;
+
+                // THE DESTINATION CLIP RECT IS SHARED BY THE THREADS: THE RECTS ARE CUT BEFORE THE BLIT
+                SDL_Rect source     = command.source;
+                SDL_Rect position   = command.position;
+                if (!clip(command.surface, &piece, &source, &position)) { continue; }
+
+                if (isBlitted(surface, command))
+                {
+                    Blitter::blit(command.mode, command.surface, &source, surface, &position, command.alpha);
+                }
+                else
+                if (SDL_BlitSurface(command.surface, &source, surface, &position))
+                {
+                    continue;
+                }
+
+                bin.nbBlits++;
+                bin.nbBlittedPixels += position.w*position.h;
+            }
+        }
+    }
+};
+
+/**
+ * Execute the commands in order then clear the list
+ * @param _surface is the destination surface
+ */
+void DisplayList::execute(SDL_Surface * _surface)
+{
+    if (nbCommands>=nbCommandsMin && ThreadPool::getNbThreads()>1 && !ThreadPool::isRunning() && prepare(_surface))
+    {
+        int nbColumns   = (_surface->w+binSize-1)/binSize;
+        int nbRows      = (_surface->h+binSize-1)/binSize;
+        Bin empty       = { 0, 0, 0 };
+
+        // BIN THE COMMANDS BY TILE IN THE LIST ORDER: COUNT (SHIFTED BY ONE), SUM, FILL, SHIFT BACK
+        bins.assign(nbColumns*nbRows+1, empty);
+        for (int pass=0; pass<2; pass++)
+        {
+            for (int i=0; i<nbCommands; i++)
+            {
+                const SDL_Rect & clip = commands[i].clip;
+                if (clip.w<=0 || clip.h<=0) { continue; }
+
+                int c1 = (clip.x+clip.w-1)/binSize, r1 = (clip.y+clip.h-1)/binSize;
+                for (int r=clip.y/binSize; r<=r1 && r<nbRows; r++)
+                for (int c=clip.x/binSize; c<=c1 && c<nbColumns; c++)
+                {
+                    if (pass)   { binned[bins[r*nbColumns+c].first++] = i; }
+                    else        { bins[r*nbColumns+c+1].first++; }
+                }
+            }
+
+            if (!pass)
+            {
+                for (unsigned int b=1; b<bins.size(); b++) { bins[b].first += bins[b-1].first; }
+                binned.resize(bins.back().first);
+            }
+        }
+        for (int b=bins.size()-1; b>0; b--) { bins[b].first = bins[b-1].first; }
+        bins[0].first = 0;
+
+        Raster raster(*this, _surface, nbColumns);
+        ThreadPool::run(&raster, nbColumns*nbRows, 1);
+
+        for (unsigned int b=0; b+1<bins.size(); b++)
+        {
+            Engine::nbBlits         += bins[b].nbBlits;
+            Engine::nbBlittedPixels += bins[b].nbBlittedPixels;
+        }
+    }
+    else
+    {
+        for (int i=0; i<nbCommands; i++)
+        {
+            SDL_SetClipRect(_surface, &commands[i].clip);
+            blit(_surface, commands[i]);
+        }
+
+        if (nbCommands) { SDL_SetClipRect(_surface, 0); }
+    }
+    nbCommands = 0;
+}
+
+/**
+ * Prepare the parallel execution: the sources blitted by SDL must keep one alpha during the list and
+ * be mapped on the destination (SDL changes the source surface when its alpha or its destination changes)
+ * @param _surface is the destination surface
+ * @return true if the tiles can be rasterized by several threads
+ */
+bool DisplayList::prepare(SDL_Surface * _surface)
+{
+    // THE LOCKED AND THE HARDWARE SURFACES ARE LEFT TO THE SERIAL EXECUTION
+    bool ret = (!SDL_MUSTLOCK(_surface) && !(_surface->flags&SDL_HWSURFACE) && _surface->w>0 && _surface->h>0);
+
+    alphas.clear();
+    for (int i=0; ret && i<nbCommands; i++)
+    {
+        // THE ENGINE BLITTER DOES NOT CHANGE ITS SOURCES
+        if (isBlitted(_surface, commands[i])) { continue; }
+
+        SDL_Surface * source = commands[i].surface;
+        Uint8 alpha = alphas.insert(std::make_pair(source, commands[i].alpha)).first->second;
+        ret = (source!=_surface && !(source->flags&SDL_HWSURFACE) && source->w>0 && source->h>0 && alpha==commands[i].alpha);
+    }
+
+    if (ret)
+    {
+        // EACH SOURCE IS MAPPED BY A ONE PIXEL BLIT, THEN THE DESTINATION PIXEL IS RESTORED
+        Uint8   pixel[4];
+        int     size = _surface->format->BytesPerPixel;
+
+        SDL_SetClipRect(_surface, 0);
+        memcpy(pixel, _surface->pixels, size);
+        for (std::tr1::unordered_map<SDL_Surface*, Uint8>::const_iterator it=alphas.begin(); it!=alphas.end(); it++)
+        {
+            SDL_Rect source     = { 0, 0, 1, 1 };
+            SDL_Rect position   = { 0, 0, 1, 1 };
+            SDL_SetAlpha(it->first, SDL_SRCALPHA | SDL_RLEACCEL, it->second);
+            SDL_BlitSurface(it->first, &source, _surface, &position);
+        }
+        memcpy(_surface->pixels, pixel, size);
+    }
+
+    return ret;
+}
+
+/**
+ * Cut the blit rects by a clip rect, with the same steps as SDL_UpperBlit
+ * @param _source is the source surface
+ * @param _clip is the clip rect
+ * @param _sourceRect is the source rect (updated)
+ * @param _position is the destination rect (updated)
+ * @return true if the blit is not empty
+ */
+bool DisplayList::clip(const SDL_Surface * _source, const SDL_Rect * _clip, SDL_Rect * _sourceRect, SDL_Rect * _position)
+{
+    int x = _sourceRect->x, y = _sourceRect->y, w = _sourceRect->w, h = _sourceRect->h;
+    int dx = _position->x,  dy = _position->y;
+    int d;
+
+    // CLIP THE SOURCE RECT TO THE SOURCE SURFACE
+    if (x<0)                    { w += x; dx -= x; x = 0; }
+    if ((d = _source->w-x)<w)   { w = d; }
+    if (y<0)                    { h += y; dy -= y; y = 0; }
+    if ((d = _source->h-y)<h)   { h = d; }
+
+    // CLIP THE DESTINATION RECT TO THE CLIP RECT
+    if ((d = _clip->x-dx)>0)                    { w -= d; dx += d; x += d; }
+    if ((d = dx+w-_clip->x-_clip->w)>0)         { w -= d; }
+    if ((d = _clip->y-dy)>0)                    { h -= d; dy += d; y += d; }
+    if ((d = dy+h-_clip->y-_clip->h)>0)         { h -= d; }
+
+    if (w>0 && h>0)
+    {
+        _sourceRect->x = x; _sourceRect->y = y; _sourceRect->w = w; _sourceRect->h = h;
+        _position->x = dx;  _position->y = dy;  _position->w = w;   _position->h = h;
+    }
+
+    return (w>0 && h>0);
+}
+
+/**
+ * Execute one command
+ * @param _surface is the destination surface
+ * @param _command is the blit command
+ */
+void DisplayList::blit(SDL_Surface * _surface, const Command & _command)
+{
+    // SDL_BLITSURFACE UPDATES THE RECTS
+    SDL_Rect source     = _command.source;
+    SDL_Rect position   = _command.position;
+
+    if (isBlitted(_surface, _command))
+    {
+        // THE RECTS ARE CUT BY THE DESTINATION CLIP RECT AS SDL_BLITSURFACE DOES
+        if (clip(_command.surface, &_surface->clip_rect, &source, &position))
+        {
+            Blitter::blit(_command.mode, _command.surface, &source, _surface, &position, _command.alpha);
+            Engine::count(position.w*position.h);
+        }
+    }
+    else
+    {
+        // SDL DOES NOTHING IF THE ALPHA HAS NOT CHANGED
+        SDL_SetAlpha(_command.surface, SDL_SRCALPHA | SDL_RLEACCEL, _command.alpha);
+        Engine::blit(_command.surface, &source, _surface, &position);
+    }
+}
+
+/**
+ * Get the blit rects of an object regarding its parent offset: the object is moved by the offset
+ * and cut by its top left corner. The source is classified for the blitter
+ * @param _position is the object position
+ * @param _source is the object source
+ * @param _offset is the parent offset (if any)
+ * @param _command is the blit command (input: surface and alpha, output: source, position and mode)
+ * @return true if the blit is not empty
+ */
+bool DisplayList::place(const SDL_Rect * _position, const SDL_Rect * _source, const SDL_Rect * _offset, Command * _command)
+{
+    SDL_Rect & vPosition    = _command->position;
+    SDL_Rect & vSource      = _command->source;
+
+    vPosition   = *_position;
+    vSource     = *_source;
+
+    if (_offset)
+    {
+        splashouille::Engine::offset(&vPosition, _offset);
+
+        if (vPosition.y<_offset->y)
+        {
+            if (vPosition.h>(_offset->y-vPosition.y)) { vPosition.h-=(_offset->y-vPosition.y); } else { vPosition.h = 0; }
+            vSource.y-=(vPosition.y-_offset->y);
+            vPosition.y = _offset->y;
+        }
+
+        if (vPosition.x<_offset->x)
+        {
+            if (vPosition.w>(_offset->x-vPosition.x)) { vPosition.w-=(_offset->x-vPosition.x); } else { vPosition.w = 0; }
+            vSource.x-=(vPosition.x-_offset->x);
+            vPosition.x = _offset->x;
+        }
+
+        vSource.w = vPosition.w;
+        vSource.h = vPosition.h;
+    }
+
+    // THE OBJECT IS CLASSIFIED ONCE: ITS BLITS IN THE UPDATE RECTS AND IN THE TILES TAKE THE SAME PATH
+    _command->mode = Blitter::classify(_command->surface, _command->alpha);
+
+    return (vPosition.w>0 && vPosition.h>0);
+}
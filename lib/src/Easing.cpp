@@ -0,0 +1,220 @@
+/*
+Copyright 2011 JohannC
+
+This file is part of SPLASHOUILLE.
+
+SPLASHOUILLE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+SPLASHOUILLE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+SPLASHOUILLE.  If not, see http://www.gnu.org/licenses/
+*/
+
+#include <splashouilleImpl/Easing.hpp>
+#include <map>
+#include <deque>
+
+#include <SDL.h>
+#include <SDL_thread.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace splashouilleImpl;
+
+/** A sampled curve */
+class Curve
+{
+public:
+    float                                       samples[Easing::nbSamples+1];   // The curve values
+};
+
+/** The table is built on first use (it is locked since the threaded import builds transitions too) */
+class EasingTable
+{
+public:
+    std::map<std::pair<double, double>, int>    curves;                 // The curve of each speeds pair
+    std::deque<Curve>                           samples;                // The samples of each curve (never moved)
+    SDL_mutex *                                 mutex;                  // The lock of the table
+
+    EasingTable()   : mutex(SDL_CreateMutex()) {}
+    ~EasingTable()  { SDL_DestroyMutex(mutex); }
+};
+
+static EasingTable & getTable()
+{
+    static EasingTable table;
+    return table;
+}
+
+/**
+ * Get the curve f(t)=at3+bt2+ct with f(0)=0, f(1)=1, f'(0)=_speedIn and f'(1)=_speedOut
+ * (the curve is sampled if it is unknown)
+ * @param _speedIn is the speed at the begin of the transition
+ * @param _speedOut is the speed at the end of the transition
+ * @return the curve id
+ */
+int Easing::get(double _speedIn, double _speedOut)
+{
+    EasingTable & table = getTable();
+    std::pair<std::map<std::pair<double, double>, int>::iterator, bool> ret;
+
+    SDL_mutexP(table.mutex);
+    ret = table.curves.insert(std::pair<std::pair<double, double>, int>(std::make_pair(_speedIn, _speedOut), table.samples.size()));
+    if (ret.second)
+    {
+        double a = _speedIn + _speedOut - 2.0;
+        double b = 3.0 - _speedIn*2 - _speedOut;
+        double c = _speedIn;
+
+        table.samples.push_back(Curve());
+        float * samples = table.samples.back().samples;
+        for (int i=0; i<nbSamples; i++)
+        {
+            double t = static_cast<double>(i)/nbSamples;
+            samples[i] = a*t*t*t + b*t*t + c*t;
+        }
+        samples[nbSamples] = 1;
+    }
+    int curve = ret.first->second;
+    SDL_mutexV(table.mutex);
+
+    return curve;
+}
+
+/**
+ * Get the samples of a curve
+ * @param _curve is the curve id
+ * @return the nbSamples+1 samples (valid until the end of the program)
+ */
+const float * Easing::getSamples(int _curve)
+{
+    EasingTable & table = getTable();
+
+    SDL_mutexP(table.mutex);
+    const float * samples = table.samples[_curve].samples;
+    SDL_mutexV(table.mutex);
+
+    return samples;
+}
+
+/**
+ * Get the ratio of a curve (the interpolation index is computed with integers)
+ * @param _samples is the curve samples
+ * @param _elapsed is the time elapsed since the beginning of the transition
+ * @param _duration is the duration of the transition
+ * @return the ratio
+ */
+float Easing::ratio(const float * _samples, int _elapsed, int _duration)
+{
+    float ret = 1;
+
+    if (_elapsed<=0) { ret = 0; } else
+    if (_elapsed<_duration)
+    {
+        // THE INDEX IS COMPUTED IN DOUBLE ONLY FOR THE VERY LONG TRANSITIONS (THE PRODUCT WOULD OVERFLOW)
+        int     index;
+        float   fraction;
+        if (_elapsed<(1<<22))
+        {
+            index       = _elapsed*nbSamples/_duration;
+            fraction    = static_cast<float>(_elapsed*nbSamples-index*_duration)/_duration;
+        }
+        else
+        {
+            double t    = static_cast<double>(_elapsed)/_duration*nbSamples;
+            index       = static_cast<int>(t);
+            fraction    = t-index;
+        }
+        if (index>=nbSamples)   { index = nbSamples-1; fraction = 1; }
+
+        ret = _samples[index] + (_samples[index+1]-_samples[index])*fraction;
+    }
+
+    return ret;
+}
+
+/**
+ * Get the ratios of a batch of transitions (same results as ratio on each transition)
+ * @param _samples are the curves samples
+ * @param _elapsed are the times elapsed since the beginning of the transitions
+ * @param _durations are the durations of the transitions
+ * @param _ratios are the ratios (output)
+ * @param _size is the number of transitions
+ */
+void Easing::ratios(const float * const * _samples, const int * _elapsed, const int * _durations, float * _ratios, int _size)
+{
+    int i = 0;
+
+#ifdef __SSE2__
+    // 4 RATIOS AT A TIME: THE INDEX AND THE REMAINDER ARE EXACT IN DOUBLE (SAME AS THE INTEGER DIVISION),
+    // ONLY THE SAMPLES ARE GATHERED LANE BY LANE
+    const __m128d   scale   = _mm_set1_pd(nbSamples);
+    const __m128i   first   = _mm_set1_epi32(1);
+    const __m128i   longest = _mm_set1_epi32((1<<22)-1);
+    const __m128    one     = _mm_set1_ps(1);
+    for (; i+4<=_size; i+=4)
+    {
+        __m128i elapsed     = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_elapsed+i));
+        __m128i duration    = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_durations+i));
+        __m128d productLo   = _mm_mul_pd(_mm_cvtepi32_pd(elapsed), scale);
+        __m128d productHi   = _mm_mul_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(elapsed, 0x4e)), scale);
+        __m128d durationLo  = _mm_cvtepi32_pd(duration);
+        __m128d durationHi  = _mm_cvtepi32_pd(_mm_shuffle_epi32(duration, 0x4e));
+        __m128i indexLo     = _mm_cvttpd_epi32(_mm_div_pd(productLo, durationLo));
+        __m128i indexHi     = _mm_cvttpd_epi32(_mm_div_pd(productHi, durationHi));
+        __m128i restLo      = _mm_cvttpd_epi32(_mm_sub_pd(productLo, _mm_mul_pd(_mm_cvtepi32_pd(indexLo), durationLo)));
+        __m128i restHi      = _mm_cvttpd_epi32(_mm_sub_pd(productHi, _mm_mul_pd(_mm_cvtepi32_pd(indexHi), durationHi)));
+        __m128  fraction    = _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi64(restLo, restHi)), _mm_cvtepi32_ps(duration));
+
+        int     index[4];
+        float   low[4], high[4];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(index), _mm_unpacklo_epi64(indexLo, indexHi));
+        for (int j=0; j<4; j++)
+        {
+            // THE LANES OUT OF THE TRANSITION READ THE FIRST SAMPLES (THEIR RATIO IS SET BELOW)
+            int k   = (index[j]<0 || index[j]>=nbSamples)?0:index[j];
+            low[j]  = _samples[i+j][k];
+            high[j] = _samples[i+j][k+1];
+        }
+        __m128  lows    = _mm_loadu_ps(low);
+        __m128  ret     = _mm_add_ps(lows, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(high), lows), fraction));
+
+        // 0 BEFORE THE TRANSITION, 1 AFTER
+        __m128  inside  = _mm_castsi128_ps(_mm_cmpgt_epi32(duration, elapsed));
+        __m128  before  = _mm_castsi128_ps(_mm_cmpgt_epi32(first, elapsed));
+        ret = _mm_or_ps(_mm_and_ps(inside, ret), _mm_andnot_ps(inside, one));
+        _mm_storeu_ps(_ratios+i, _mm_andnot_ps(before, ret));
+
+        // THE VERY LONG TRANSITIONS ARE COMPUTED BY THE SCALAR PATH
+        int longs = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(elapsed, longest)));
+        for (int j=0; longs && j<4; j++)
+        {
+            if (longs&(1<<j)) { _ratios[i+j] = ratio(_samples[i+j], _elapsed[i+j], _durations[i+j]); }
+        }
+    }
+#endif
+
+    for (; i<_size; i++) { _ratios[i] = ratio(_samples[i], _elapsed[i], _durations[i]); }
+}
+
+/**
+ * Get the number of curves
+ * @return the size of the table
+ */
+int Easing::getSize()
+{
+    EasingTable & table = getTable();
+
+    SDL_mutexP(table.mutex);
+    int size = table.samples.size();
+    SDL_mutexV(table.mutex);
+
+    return size;
+}
@@ -22,9 +22,14 @@ SPLASHOUILLE.  If not, see http://www.gnu.org/licenses/
 #include <splashouilleImpl/Fashion.hpp>
 #include <splashouilleImpl/Style.hpp>
 #include <splashouilleImpl/Crowd.hpp>
+#include <splashouilleImpl/ThreadPool.hpp>
+#include <splashouilleImpl/DisplayList.hpp>
 #include <libconfig.h++>
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
+#include <time.h>
+#include <errno.h>
 
 #include <SDL.h>
 #include <SDL_mixer.h>
@@ -33,11 +38,24 @@ SPLASHOUILLE.  If not, see http://www.gnu.org/licenses/
 
 using namespace splashouilleImpl;
 
-/** splashouille init SDL method */
-bool splashouille::Engine::init()
+/**
+ * splashouille init SDL method
+ * @param _headless is true for using the SDL dummy drivers (no window, no sound device)
+ * @return true if succeed
+ */
+bool splashouille::Engine::init(bool _headless)
 {
     bool ret = true; 
 
+    // THE DUMMY DRIVERS ALLOW RUNNING WITHOUT ANY DISPLAY
+    if (_headless)
+    {
+        static char videoDriver[] = "SDL_VIDEODRIVER=dummy";
+        static char audioDriver[] = "SDL_AUDIODRIVER=dummy";
+        SDL_putenv(videoDriver);
+        SDL_putenv(audioDriver);
+    }
+
     //Initialisation de tous les sous-systèmes de SDL
     if( SDL_Init( SDL_INIT_EVERYTHING ) == -1 )                         { ret = false; }
 
@@ -51,7 +69,7 @@ bool splashouille::Engine::init()
 splashouille::Engine * splashouille::Engine::createEngine()
 {
     splashouilleImpl::Library * l       = new splashouilleImpl::Library();
-    splashouille::Engine *      ret     = new splashouilleImpl::Engine(l);
+    splashouilleImpl::Engine *  ret     = new splashouilleImpl::Engine(l);
     l->insertObject(ROOT, ret);
     return ret;
 }
@@ -60,8 +78,34 @@ void splashouille::Engine::deleteEngine(splashouille::Engine * _engine)
     delete dynamic_cast<splashouilleImpl::Engine*>(_engine);
 }
 
+/** The phases names */
+static const char * phaseNames[splashouille::Engine::Profile::last] =
+    { "events", "mouseEvent", "onFrame", "update", "render", "flip", "total" };
+
+/**
+ * Get the phase name
+ * @param _phase is the phase
+ * @return the name of the phase
+ */
+const char * splashouille::Engine::Profile::getName(phaseEnum _phase)
+{
+    return (_phase>=0 && _phase<last)?phaseNames[_phase]:"";
+}
+
+/**
+ * Get the monotonic time of the system (not the engine clock, used for profiling)
+ * @return the time in milliseconds
+ */
+static double monotonicTime()
+{
+    timespec t;
+    return (clock_gettime(CLOCK_MONOTONIC, &t)==0)?t.tv_sec*1000.0 + t.tv_nsec/1000000.0:SDL_GetTicks();
+}
+
 /** Static values */
 bool                                Engine::debug           = false;
+long                                Engine::nbBlits         = 0;
+long                                Engine::nbBlittedPixels = 0;
 splashouille::Object *              Engine::mouse           = 0;
 int                                 Engine::mouseOffset[2]  = {0, 0};
 splashouille::Engine::mouseModeEnum Engine::mouseMode       = splashouille::Engine::inactive;
@@ -129,6 +173,36 @@ void splashouille::Engine::copy(SDL_Rect * _dest, const SDL_Rect * _source)
     if (_dest && _source) { _dest->x = _source->x; _dest->y = _source->y; _dest->w = _source->w; _dest->h = _source->h; }
 }
 
+/**
+ * Blit a surface as the objects are rendered: with the engine blitter for the 32 bits surfaces,
+ * with SDL for the others
+ * @param _source is the source surface
+ * @param _sourceRect is the source rect (0 for the whole surface)
+ * @param _destination is the destination surface
+ * @param _position is the destination position (0 for the top left corner)
+ * @param _alpha is the surface alpha
+ * @param _sdl is true for forcing the SDL blitters (comparison)
+ */
+void splashouille::Engine::blitSurface(SDL_Surface * _source, const SDL_Rect * _sourceRect,
+                                       SDL_Surface * _destination, const SDL_Rect * _position, Uint8 _alpha, bool _sdl)
+{
+    DisplayList::Command command;
+
+    command.surface     = _source;
+    command.alpha       = _alpha;
+    command.source.x    = _sourceRect?_sourceRect->x:0;
+    command.source.y    = _sourceRect?_sourceRect->y:0;
+    command.source.w    = _sourceRect?_sourceRect->w:_source->w;
+    command.source.h    = _sourceRect?_sourceRect->h:_source->h;
+    command.position.x  = _position?_position->x:0;
+    command.position.y  = _position?_position->y:0;
+    command.position.w  = command.source.w;
+    command.position.h  = command.source.h;
+    command.mode        = _sdl?Blitter::sdl:Blitter::classify(_source, _alpha);
+
+    DisplayList::blit(_destination, command);
+}
+
 /**
  * are two rects intersecting ?
  * @param _first is the first rect
@@ -150,8 +224,12 @@ bool  splashouille::Engine::inter(const SDL_Rect * _first, const SDL_Rect * _sec
 
 // TODO: are Object and Animation constructors both mandatory ?
 Engine::Engine(Library * _library): Object(ROOT), Animation(ROOT, _library),
-    library(_library), running(false), frame(0), background(0), fps(0), onPause(true)
+    library(_library), running(false), frame(0), background(0), fps(0), onPause(true), looping(false),
+    begin(0), now(0), progress(0), clock(0), frameSec(0), lastSecond(0), profileIndex(0), nbProfileSamples(0)
 {
+    for (int i=0; i<splashouille::Engine::Profile::last; i++) { phases[i] = 0; }
+    profile.nbFrames = profile.nbUpdateRects = profile.nbUpdatedPixels = profile.nbFullUpdates = 0;
+    getProfile();
     animationType = splashouille::Animation::group;
 }
 
@@ -159,6 +237,7 @@ Engine::~Engine()
 {
     delete library;
     for (std::list<ListenerElement*>::iterator it=listeners.begin(); it!=listeners.end(); it++) { delete (*it); }
+    ThreadPool::stop();
 }
 
 /** Some accessors */
@@ -215,6 +294,7 @@ bool Engine::import(libconfig::Config * _config, bool _thread)
 void Engine::stop()
 {
     running   = false;
+    wakeUp();
 }
 
 /**
@@ -222,7 +302,25 @@ void Engine::stop()
  */
 void Engine::pause()
 {
-    if (!(onPause=!onPause)) { int delta=now-begin; now = SDL_GetTicks(); begin = now-delta; }
+    if (!(onPause=!onPause)) { int delta=now-begin; now = getTicks(); begin = now-delta; }
+    wakeUp();
+}
+
+/**
+ * Wake the event loop up (it may be waiting for an event while stop or pause is called from another thread)
+ */
+void Engine::wakeUp()
+{
+    // THE EVENT IS RECOGNIZED BY THE LOOP (IT IS NOT FORWARDED TO THE LISTENERS)
+    if (looping)
+    {
+        SDL_Event event;
+        event.type          = SDL_USEREVENT;
+        event.user.code     = 0;
+        event.user.data1    = this;
+        event.user.data2    = 0;
+        SDL_PushEvent(&event);
+    }
 }
 
 /**
@@ -260,19 +358,110 @@ bool Engine::deleteListener(splashouille::Engine::Listener * _listener)
     return ret;
 }
 
+/**
+ * Get the current time from the clock with a sub-millisecond precision
+ * @return the current time in milliseconds
+ */
+double Engine::getTime()
+{
+    return clock?clock->getTicks():monotonicTime();
+}
+
+/**
+ * Sleep until a deadline (the thread is suspended, no busy wait)
+ * @param _deadline is the wake up time in milliseconds (same origin as getTime)
+ */
+void Engine::sleepUntil(double _deadline)
+{
+    double delta = _deadline - getTime();
+
+    if (delta>0)
+    {
+        timespec t, left;
+        t.tv_sec    = static_cast<time_t>(delta/1000);
+        t.tv_nsec   = static_cast<long>((delta-t.tv_sec*1000.0)*1000000.0);
+
+        // NANOSLEEP MAY BE INTERRUPTED BY A SIGNAL: SLEEP THE REMAINING TIME
+        while (nanosleep(&t, &left)==-1 && errno==EINTR) { t = left; }
+    }
+}
+
+/**
+ * Store the phases durations of the current frame in the ring buffer
+ */
+void Engine::recordProfile()
+{
+    phases[splashouille::Engine::Profile::total] = 0;
+    for (int i=0; i<splashouille::Engine::Profile::total; i++)
+    {
+        phases[splashouille::Engine::Profile::total] += phases[i];
+    }
+
+    for (int i=0; i<splashouille::Engine::Profile::last; i++)
+    {
+        profileSamples[i][profileIndex] = phases[i];
+        phases[i] = 0;
+    }
+
+    profileIndex = (profileIndex+1)%nbProfileSamplesMax;
+    if (nbProfileSamples<nbProfileSamplesMax) { nbProfileSamples++; }
+}
+
+/**
+ * Get the duration summary of the last frames phases
+ * @return the frame profile
+ */
+const splashouille::Engine::Profile * Engine::getProfile()
+{
+    float sorted[nbProfileSamplesMax];
+
+    profile.nbSamples       = nbProfileSamples;
+    profile.nbBlits         = nbBlits;
+    profile.nbBlittedPixels = nbBlittedPixels;
+    for (int i=0; i<splashouille::Engine::Profile::last; i++)
+    {
+        profile.min[i] = profile.avg[i] = profile.p95[i] = profile.p99[i] = 0;
+
+        if (nbProfileSamples)
+        {
+            // THE RING BUFFER IS SMALL: SORTING A COPY IS CHEAPER THAN MAINTAINING HISTOGRAMS
+            double sum = 0;
+            for (int j=0; j<nbProfileSamples; j++) { sorted[j] = profileSamples[i][j]; sum += sorted[j]; }
+            std::sort(sorted, sorted+nbProfileSamples);
+
+            profile.min[i] = sorted[0];
+            profile.avg[i] = sum/nbProfileSamples;
+            profile.p95[i] = sorted[(nbProfileSamples*95-1)/100];
+            profile.p99[i] = sorted[(nbProfileSamples*99-1)/100];
+        }
+    }
+
+    return &profile;
+}
+
 /**
  * Flip the surface
  * @param _surface
  */
 void Engine::flip(SDL_Surface * _surface)
 {
-    //SDL_Flip(_surface); return;
-    if (numberOfPixels >= _surface->w*_surface->h)  { SDL_Flip(_surface); }
-    else                                            { SDL_UpdateRects(_surface, nbUpdateRects, updateRects); }
+    if (isFullUpdate(_surface))     { SDL_Flip(_surface); }
+    else                            { SDL_UpdateRects(_surface, nbUpdateRects, updateRects); }
 
     clear();
 }
 
+/**
+ * Choose between a full update and the update rects
+ * @param _surface is the screen surface
+ * @return true if the full update is cheaper
+ */
+bool Engine::isFullUpdate(SDL_Surface * _surface)
+{
+    prepareUpdateRects();
+    return Region::isFullUpdateCheaper(numberOfPixels, nbUpdateRects, _surface->w, _surface->h);
+}
+
 
 /**
  * Erase the updated parts (if any)
@@ -284,24 +473,32 @@ void Engine::fillWithBackground()
 
     if (numberOfPixels && nbUpdateRects && bg!=splashouille::Animation::none)
     {
-        if (numberOfPixels > surface->w*surface->h)
+        SDL_Rect all = { 0, 0, static_cast<Uint16>(surface->w), static_cast<Uint16>(surface->h) };
+
+        // THE AREAS COVERED BY AN OPAQUE OBJECT ARE NOT FILLED
+        if (numberOfPixels >= surface->w*surface->h)
         {
-            if (bg==splashouille::Animation::copy && background)
-            {
-                SDL_BlitSurface(background, 0, surface, 0);
-            }
-            else
+            if (!crowd->isOccluded(&all))
             {
-                SDL_FillRect(surface, 0, SDL_MapRGB(surface->format, r, g, 0));
+                if (bg==splashouille::Animation::copy && background)
+                {
+                    blit(background, 0, surface, 0);
+                }
+                else
+                {
+                    SDL_FillRect(surface, 0, SDL_MapRGB(surface->format, r, g, 0));
+                }
             }
         }
         else
         {
             for (int i=0; i<nbUpdateRects; i++)
             {
+                if (crowd->isOccluded(&updateRects[i])) { continue; }
+
                 if (bg==splashouille::Animation::copy && background)
                 {
-                    SDL_BlitSurface(background, &updateRects[i], surface , &updateRects[i]);
+                    blit(background, &updateRects[i], surface , &updateRects[i]);
                 }
                 else
                 {
@@ -313,26 +510,17 @@ void Engine::fillWithBackground()
 }
 
 /**
- * Run the animation
+ * Prepare the engine before running the animation
  * @param _surface is the SDL surface for rendering the animation
  * @param _bg for handling the background
- * @return true if everything is fine
+ * @param _display is false if the surface is not the video surface
  */
-bool Engine::run(SDL_Surface * _surface, splashouille::Animation::backgroundEnum _bg)
+void Engine::start(SDL_Surface * _surface, splashouille::Animation::backgroundEnum _bg, bool _display)
 {
-    SDL_Event       event;
-    int             frameSec        = 0;
-    unsigned int    lastSecond      = 0;
-    Uint32          lastNow         = 0;
-    Uint16          mouseX          = 0;
-    Uint16          mouseY          = 0;
-    int             mouseState      = 0;
-    bool            rc;
-    int             delay           = fps?1000/fps:1;
-
-    // Save the background
+    // Save the background (SDL_DisplayFormat NEEDS A VIDEO MODE)
     bg              = _bg;
-    background      = SDL_DisplayFormat(_surface);
+    background      = _display?SDL_DisplayFormat(_surface):
+                               SDL_ConvertSurface(_surface, _surface->format, _surface->flags);
 
     // Some initialisations
     getStyle()->setTop(0);
@@ -344,21 +532,140 @@ bool Engine::run(SDL_Surface * _surface, splashouille::Animation::backgroundEnum
     position->w = _surface->w;
     position->h = _surface->h;
 
-    running = true;
-    onPause = false;
-    begin   = SDL_GetTicks();
-    now     = begin;
+    running     = true;
+    onPause     = false;
+    frameSec    = 0;
+    lastSecond  = 0;
+
+    // RESET THE PROFILE COUNTERS
+    nbBlits                 = 0;
+    nbBlittedPixels         = 0;
+    profile.nbFrames        = 0;
+    profile.nbUpdateRects   = 0;
+    profile.nbUpdatedPixels = 0;
+    profile.nbFullUpdates   = 0;
+}
+
+/**
+ * Process one frame: listeners, update and render
+ * @param _surface is the SDL surface for rendering the animation
+ * @param _display is false if the surface is not the video surface (no flip)
+ * @param _update is false if nothing is due in the scene (only the listeners are called)
+ */
+void Engine::process(SDL_Surface * _surface, bool _display, bool _update)
+{
+    double time = monotonicTime();
+    double last;
+
+    // DEAL WITH THE ONFRAME LISTENER
+    for (std::list<ListenerElement*>::iterator it=listeners.begin(); it!=listeners.end(); it++)
+    {
+        (*it)->listener->onFrame(frame, now-begin);
+    }
+    last = time; time = monotonicTime(); phases[splashouille::Engine::Profile::onFrame] = time-last;
+
+    // HANDLE THE TIMELINE EVENT (A CHANGE MADE BY THE LISTENERS WAKES THE SCENE UP)
+    if (_update || getWakeTimestamp()<=static_cast<int>(now-begin)) { update(now-begin); }
+    last = time; time = monotonicTime(); phases[splashouille::Engine::Profile::update] = time-last;
+
+    // DEAL WITH THE ONSECOND LISTENER IF SECOND IS DIFFERENT
+    if (lastSecond!=(now-begin)/1000)
+    {
+        lastSecond = (now-begin)/1000;
+        getProfile();
+        for (std::list<ListenerElement*>::iterator it=listeners.begin(); it!=listeners.end(); it++)
+        {
+            (*it)->listener->onSecond(frame, frameSec, lastSecond, &profile);
+        }
+
+        if (debug) {
+            std::cout<<std::setw(STD_LABEL)<<std::left<<"Engine::onSecond"
+                    <<" (second: "<<lastSecond<<") (fps: "<<frameSec<<")"
+                    <<" (frame avg: "<<profile.avg[splashouille::Engine::Profile::total]<<"ms)"
+                    <<" (frame p99: "<<profile.p99[splashouille::Engine::Profile::total]<<"ms)"<<std::endl;
+            if (lastSecond%5==0) { log(); }
+        }
+
+        frameSec = 0;
+
+        // THE LISTENERS ARE NOT PART OF THE FRAME PROFILE
+        time = monotonicTime();
+    }
+
+    // Render the main animation
+    if (numberOfPixels)
+    {
+        render(_surface);
+        last = time; time = monotonicTime(); phases[splashouille::Engine::Profile::render] = time-last;
+
+        if (isFullUpdate(_surface))
+        {
+            profile.nbFullUpdates++;
+            profile.nbUpdateRects++;
+            profile.nbUpdatedPixels += _surface->w*_surface->h;
+        }
+        else
+        {
+            profile.nbUpdateRects   += nbUpdateRects;
+            profile.nbUpdatedPixels += numberOfPixels;
+        }
+
+        if (_display)   { flip(_surface); }
+        else            { clear(); }
+        last = time; time = monotonicTime(); phases[splashouille::Engine::Profile::flip] = time-last;
+    }
+
+    recordProfile();
+    profile.nbFrames++;
+    frame++; frameSec++;
+}
+
+/**
+ * Run the animation
+ * @param _surface is the SDL surface for rendering the animation
+ * @param _bg for handling the background
+ * @return true if everything is fine
+ */
+bool Engine::run(SDL_Surface * _surface, splashouille::Animation::backgroundEnum _bg)
+{
+    SDL_Event       event;
+    Uint16          mouseX          = 0;
+    Uint16          mouseY          = 0;
+    int             mouseState      = 0;
+    bool            rc;
+    double          period          = fps?1000.0/fps:1.0;
+    double          time;
+    double          deadline;
+    double          profileTime;
+    bool            hasEvent;
+    bool            input           = true;
+    bool            due;
+
+    start(_surface, _bg, true);
+    looping     = true;
+    time        = getTime();
+    deadline    = time;
+    begin       = static_cast<Uint32>(time);
+    now         = begin;
 
     while(running)
     {
         // INIT THE EVENT
         event.type = 0;
 
+        // ON PAUSE NOTHING CAN CHANGE WITHOUT AN EVENT: BLOCK UNTIL THE NEXT ONE
+        if (onPause)    { hasEvent = SDL_WaitEvent(&event); profileTime = monotonicTime(); }
+        else            { profileTime = monotonicTime(); hasEvent = SDL_PollEvent(&event); }
+
         // Handle the poll event
-        while (SDL_PollEvent(&event))
+        for (; hasEvent; hasEvent = SDL_PollEvent(&event))
         {
             rc = false;
 
+            // THE WAKE-UP EVENTS OF STOP AND PAUSE ONLY BREAK THE WAIT
+            if (event.type == SDL_USEREVENT && event.user.data1 == this) { event.type = 0; continue; }
+            input = true;
+
             // The QUIT EVENT
             if (event.type == SDL_QUIT)
             {
@@ -407,61 +714,83 @@ bool Engine::run(SDL_Surface * _surface, splashouille::Animation::backgroundEnum
             }
         }
 
-        // THE MILLISECOND IS THE LIMIT OF THE SDL_GETTICKS()
-        if (!onPause && now>=lastNow+delay)
+        phases[splashouille::Engine::Profile::events] += monotonicTime()-profileTime;
+        time = getTime();
+        now  = static_cast<Uint32>(time);
+
+        // THE FRAME DEADLINES ARE COMPUTED WITH A FRACTIONAL PERIOD (NO DRIFT AT 60FPS)
+        if (!onPause && time>=deadline)
         {
+            // WITHOUT INPUT, NOTHING CHANGES BEFORE THE NEXT WAKE-UP OF THE SCENE: THE FRAME ONLY CALLS THE LISTENERS
+            due     = input || getWakeTimestamp()<=static_cast<int>(now-begin);
+            input   = false;
+
             // FORWARD THE MOUSE EVENT (USER<0 MAKE THE MOUSE TEMPORARY INACTIVE)
-            if ( (  mouseMode == splashouille::Engine::active) ||
-                 (  mouseMode == splashouille::Engine::object && mouse &&
-                    mouse->getStyle()->getDisplay() && mouse->getStyle()->getUser()>=0 ) )
+            if ( due && (  (  mouseMode == splashouille::Engine::active) ||
+                           (  mouseMode == splashouille::Engine::object && mouse &&
+                              mouse->getStyle()->getDisplay() && mouse->getStyle()->getUser()>=0 ) ) )
             {
+                profileTime = monotonicTime();
                 mouseEvent(now-begin, event.button.x, event.button.y, true, mouseState);
+                phases[splashouille::Engine::Profile::mouseEvent] = monotonicTime()-profileTime;
             }
 
-            // UPDATE THE ELEMENTS
-            lastNow = now;
-
-            // DEAL WITH THE ONFRAME LISTENER
-            for (std::list<ListenerElement*>::iterator it=listeners.begin(); it!=listeners.end(); it++)
-            {
-                (*it)->listener->onFrame(frame, now-begin);
-            }
+            // UPDATE THE ELEMENTS (AND RENDER THE DAMAGED AREAS IF ANY)
+            process(_surface, true, due);
 
-            // HANDLE THE TIMELINE EVENT
-            update(now-begin);
+            // SKIP THE MISSED FRAMES INSTEAD OF RUNNING THEM IN A BURST
+            deadline += period;
+            if (deadline+period<time) { deadline = time+period; }
+        }
+        else
+        if (onPause)
+        {
+            // THE DEADLINE RESTARTS FROM THE END OF THE PAUSE
+            deadline = time;
+        }
+        else
+        {
+            // SLEEP UNTIL THE NEXT FRAME (THE INPUT LATENCY IS AT MOST ONE FRAME)
+            sleepUntil(deadline);
+        }
+    }
 
-            // DEAL WITH THE ONSECOND LISTENER IF SECOND IS DIFFERENT
-            if (lastSecond!=(now-begin)/1000)
-            {
-                lastSecond = (now-begin)/1000;
-                for (std::list<ListenerElement*>::iterator it=listeners.begin(); it!=listeners.end(); it++)
-                {
-                    (*it)->listener->onSecond(frame, frameSec, lastSecond);
-                }
+    looping = false;
+    SDL_FreeSurface(background); background = 0;
 
-                if (debug) {
-                    std::cout<<std::setw(STD_LABEL)<<std::left<<"Engine::onSecond"
-                            <<" (second: "<<lastSecond<<") (fps: "<<frameSec<<")"<<std::endl;
-                    if (lastSecond%5==0) { log(); }
-                }
+    return true;
+}
 
-                frameSec = 0;
-            }
+/**
+ * Run the animation without display
+ * @param _surface is the offscreen SDL surface for rendering the animation
+ * @param _nbFrames is the number of frames to render (-1 for no limit)
+ * @param _stepInMilliSeconds is the virtual time between two frames (0 needs a number of frames)
+ * @param _timeStampMax is the last timestamp to render (-1 for no limit)
+ * @param _bg for handling the background
+ * @return true if everything is fine
+ */
+bool Engine::runHeadless(SDL_Surface * _surface, int _nbFrames, int _stepInMilliSeconds, int _timeStampMax,
+                         splashouille::Animation::backgroundEnum _bg)
+{
+    int             nbFrames        = 0;
 
-            // Render the main animation
-            if (numberOfPixels)
-            {
-                render(_surface);
-                flip(_surface);
-            }
+    if (!_surface || _stepInMilliSeconds<0 || (_nbFrames<0 && _stepInMilliSeconds==0)) { return false; }
 
-            frame++; frameSec++;
-        }
+    start(_surface, _bg, false);
+    begin   = 0;
+    now     = 0;
 
-        now = SDL_GetTicks();
+    // THE VIRTUAL TIME IS ONLY DRIVEN BY THE STEP: THE RESULT DOES NOT DEPEND ON THE HOST SPEED
+    while (running && (_nbFrames<0 || nbFrames<_nbFrames) && (_timeStampMax<0 || now<=(Uint32)_timeStampMax))
+    {
+        if (!onPause) { process(_surface, false); }
+        nbFrames++;
+        now += _stepInMilliSeconds;
     }
 
-     SDL_FreeSurface(background);
+    running = false;
+    SDL_FreeSurface(background); background = 0;
 
     return true;
 }
@@ -24,6 +24,7 @@ SPLASHOUILLE.  If not, see http://www.gnu.org/licenses/
 #include <splashouilleImpl/Animation.hpp>
 #include <splashouilleImpl/Timeline.hpp>
 #include <splashouilleImpl/Event.hpp>
+#include <splashouilleImpl/Symbol.hpp>
 #include <libconfig.h++>
 #include <iostream>
 #include <iomanip>
@@ -36,7 +37,8 @@ int Event::garbageNumber    = 0;
 int Event::eventCount       = 0;
 
 Event::Event(Timeline * _timeline):
-    timeStampInMilliSeconds(0), type(none), object(0), timeline(_timeline), value(0), valueStr(""), option(false)
+    timeStampInMilliSeconds(0), type(none), object(0), targetAnimation(0), revision(0), bound(false), timeline(_timeline),
+    value(0), valueStr(""), valueSymbol(Symbol::empty), option(false)
 {
     garbageNumber++;
 }
@@ -79,7 +81,7 @@ bool Event::import(splashouille::Library * _library, libconfig::Setting & _setti
         type = insert;
         object = _library->createObject(_setting);
         objectId = object->getId();
-        objectIds.push_back(objectId);
+        objectSymbols.push_back(Symbol::get(objectId));
     }
     else if (!typeStr.compare(EVENT_TYPE_COPY) )
     {
@@ -87,7 +89,7 @@ bool Event::import(splashouille::Library * _library, libconfig::Setting & _setti
 
         if (_setting.exists(EVENT_OBJECTID)) { _setting.lookupValue(EVENT_OBJECTID, objectId); }
         else                                 { char m[128]; snprintf(m, 128, "__event%05d", eventCount-1); objectId.assign(m); }
-        objectIds.push_back(objectId);
+        objectSymbols.push_back(Symbol::get(objectId));
 
         std::string parentStr;
         _setting.lookupValue(EVENT_PARENT, parentStr);
@@ -114,7 +116,7 @@ bool Event::import(splashouille::Library * _library, libconfig::Setting & _setti
             if (setting.getType()== libconfig::Setting::TypeString)
             {
                 _setting.lookupValue(EVENT_OBJECTID, objectId);
-                objectIds.push_back(objectId);
+                objectSymbols.push_back(Symbol::get(objectId));
             }
             else
             if (setting.getType()== libconfig::Setting::TypeList)
@@ -122,7 +124,7 @@ bool Event::import(splashouille::Library * _library, libconfig::Setting & _setti
                 for (int i=0; i<setting.getLength(); i++)
                 {
                     objectId.assign((const char*)setting[i]);
-                    objectIds.push_back(objectId);
+                    objectSymbols.push_back(Symbol::get(objectId));
                 }
             }
         }
@@ -141,7 +143,7 @@ bool Event::import(splashouille::Library * _library, libconfig::Setting & _setti
         if (_setting.exists(EVENT_OBJECTID))
         {
             _setting.lookupValue(EVENT_OBJECTID, objectId);
-            objectIds.push_back(objectId);
+            objectSymbols.push_back(Symbol::get(objectId));
         }
 
        _setting.lookupValue(EVENT_OPTION, option);
@@ -163,7 +165,7 @@ bool Event::import(splashouille::Library * _library, libconfig::Setting & _setti
             if (setting.getType()== libconfig::Setting::TypeString)
             {
                 _setting.lookupValue(EVENT_OBJECTID, objectId);
-                objectIds.push_back(objectId);
+                objectSymbols.push_back(Symbol::get(objectId));
             }
             else
             if (setting.getType()== libconfig::Setting::TypeList)
@@ -171,7 +173,7 @@ bool Event::import(splashouille::Library * _library, libconfig::Setting & _setti
                 for (int i=0; i<setting.getLength(); i++)
                 {
                     objectId.assign((const char*)setting[i]);
-                    objectIds.push_back(objectId);
+                    objectSymbols.push_back(Symbol::get(objectId));
                 }
             }
         }
@@ -179,7 +181,7 @@ bool Event::import(splashouille::Library * _library, libconfig::Setting & _setti
         {
             option = true;
             _setting.lookupValue(EVENT_TAG, objectId);
-            objectIds.push_back(objectId);
+            objectSymbols.push_back(Symbol::get(objectId));
         }
     }
     else if (!typeStr.compare(EVENT_TYPE_STATE) )
@@ -190,7 +192,7 @@ bool Event::import(splashouille::Library * _library, libconfig::Setting & _setti
         if (_setting.exists(EVENT_OBJECTID))
         {
             _setting.lookupValue(EVENT_OBJECTID, objectId);
-            objectIds.push_back(objectId);
+            objectSymbols.push_back(Symbol::get(objectId));
         }
     }
     else
@@ -198,9 +200,38 @@ bool Event::import(splashouille::Library * _library, libconfig::Setting & _setti
         ret = false;
     }
 
+    // THE FASHION AND TIMELINE IDS ARE RESOLVED ONCE
+    valueSymbol = Symbol::get(valueStr);
+
     return ret;
 }
 
+/**
+ * Bind the object ids to the library objects (again if objects have been inserted or deleted since)
+ * @param _library is the objects library
+ */
+void Event::bind(Library * _library)
+{
+    if (!bound || revision!=_library->getRevision())
+    {
+        targets.clear();
+        targetAnimation = 0;
+
+        // THE TAGS OF THE FASHION CHANGE ARE NOT OBJECT IDS
+        if (type!=changefashion || !option)
+        {
+            for (unsigned int i=0; i<objectSymbols.size(); i++) { targets.push_back(_library->getObjectBySymbol(objectSymbols[i])); }
+        }
+        if (type==changetimeline && targets.size() && targets[0] && targets[0]->kind==Object::kindAnimation)
+        {
+            targetAnimation = targets[0]->concrete.animation;
+        }
+
+        revision    = _library->getRevision();
+        bound       = true;
+    }
+}
+
 /**
  * Run an event
  * @param _timestamp is the current timestamp
@@ -209,57 +240,57 @@ bool Event::import(splashouille::Library * _library, libconfig::Setting & _setti
 bool Event::run(int _timestamp)
 {
     bool                        ret = true;
-    splashouille::Animation *   animation = timeline?timeline->getAnimation():0;
-    splashouille::Crowd *       crowd = animation?animation->getCrowd():0;
+    Animation *                 animation = timeline?dynamic_cast<Animation*>(timeline->getAnimation()):0;
+    Crowd *                     crowd = animation?dynamic_cast<Crowd*>(animation->getCrowd()):0;
+    Library *                   library = animation?dynamic_cast<Library*>(animation->getLibrary()):0;
 
-    if (timeline && animation && crowd)
+    if (timeline && animation && crowd && library)
     {
+        // THE TARGETS ARE RESOLVED ONCE, UNTIL AN OBJECT IS INSERTED OR DELETED
+        bind(library);
 
         // Handle the event
         switch(type)
         {
         case insert:
         case copy:              crowd->insertObject(_timestamp, object); break;
-        case close:             for (unsigned int i=0;i<objectIds.size();i++) { crowd->dropObject(objectIds[i]); } break;
+        case close:             for (unsigned int i=0;i<targets.size();i++) { if (targets[i]) { crowd->dropObject(targets[i]); } } break;
         case moveto:            timeline->move(_timestamp, value); ret = false; break;
-        case changetimeline:    if (objectIds.size())
+        case changetimeline:    if (objectSymbols.size())
                                 {
-                                    splashouille::Animation * a = animation->getLibrary()->getAnimationById(objectIds[0]);
-                                    if (a) { a->changeTimeline(valueStr, option); }
+                                    if (targetAnimation) { targetAnimation->changeTimeline(valueSymbol, option); }
                                 }
                                 else
                                 {
-                                    animation->changeTimeline(valueStr, option);
+                                    animation->changeTimeline(valueSymbol, option);
                                     ret = false;
                                 }
                                 break;
         case clearcrowd:        crowd->clear(valueStr); break;
-        case changefashion:     if (objectIds.size())
+        case changefashion:     if (objectSymbols.size())
                                 {
-                                    for (unsigned int i=0;i<objectIds.size();i++)
+                                    for (unsigned int i=0;i<objectSymbols.size();i++)
                                     {
                                         if (option)
                                         {
-                                            animation->getCrowd()->changeFashion(valueStr, objectIds[i]);
+                                            crowd->changeFashion(valueSymbol, objectSymbols[i]);
                                         }
                                         else
                                         {
-                                            splashouille::Object * o = animation->getLibrary()->getObjectById(objectIds[i]);
-                                            if (o) { o->changeFashion(valueStr); }
+                                            if (targets[i]) { targets[i]->changeFashion(valueSymbol); }
                                         }
                                     }
                                 }
                                 else
                                 {
-                                    animation->changeFashion(valueStr);
+                                    animation->changeFashion(valueSymbol);
                                 }
                                 break;
-        case state:             if (objectIds.size())
+        case state:             if (targets.size())
                                 {
-                                    for (unsigned int i=0;i<objectIds.size();i++)
+                                    for (unsigned int i=0;i<targets.size();i++)
                                     {
-                                        splashouille::Object * o = animation->getLibrary()->getObjectById(objectIds[i]);
-                                        if (o) { o->setState(value); }
+                                        if (targets[i]) { targets[i]->setState(value); }
                                     }
                                 }
                                 else
@@ -289,10 +320,10 @@ void Event::log(int _rank) const
 {
     std::string offset; offset.append(4*_rank,' ');
     std::cout<<offset<<"+ Event (timestamp:"<<timeStampInMilliSeconds<<") (type:"<<type<<") (id: "<<id<<")";
-    if (objectIds.size())
+    if (objectSymbols.size())
     {
         std::cout<<" (objectIds:";
-        for (unsigned int i=0; i<objectIds.size(); i++) std::cout<<" "<<objectIds[i];
+        for (unsigned int i=0; i<objectSymbols.size(); i++) std::cout<<" "<<Symbol::getName(objectSymbols[i]);
         std::cout<<")";
     }
     if (value) { std::cout<<" (value: "<<value<<")"; }
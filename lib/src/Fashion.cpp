@@ -18,11 +18,14 @@ SPLASHOUILLE.  If not, see http://www.gnu.org/licenses/
 #include <splashouille/Defines.hpp>
 #include <splashouilleImpl/Fashion.hpp>
 #include <splashouilleImpl/Style.hpp>
+#include <splashouilleImpl/Easing.hpp>
+#include <splashouilleImpl/Object.hpp>
 
 #include <libconfig.h++>
 
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
 
 using namespace splashouilleImpl;
 
@@ -37,26 +40,20 @@ using namespace splashouilleImpl;
  */
 Fashion::Transition::Transition(int _timestampIn, int _timestampOut, double _speedIn, double _speedOut, int _period) :
     timestampIn(_timestampIn), timestampOut(_timestampOut), speedIn(_speedIn), speedOut(_speedOut),
-    period(_period), nbTimes(0), done(false)
+    period(_period), nbTimes(0), done(false), order(0)
 {
     style = new Style();
-
-    a = speedIn + speedOut - 2.0;
-    b = 3.0 - speedIn*2 - speedOut;
-    c = speedIn;
+    curve = Easing::getSamples(Easing::get(speedIn, speedOut));
 }
 
 /**
  * Another constructor
  */
 Fashion::Transition::Transition(Transition * _t):
-    timestampIn(_t->timestampIn), timestampOut(_t->timestampOut), speedIn(_t->speedIn), speedOut(_t->speedOut), period(_t->period), nbTimes(_t->nbTimes), done(false)
+    timestampIn(_t->timestampIn), timestampOut(_t->timestampOut), speedIn(_t->speedIn), speedOut(_t->speedOut), period(_t->period), nbTimes(_t->nbTimes), done(false), order(0)
 {
     style = new Style(_t->style);
-
-    a = speedIn + speedOut - 2.0;
-    b = 3.0 - speedIn*2 - speedOut;
-    c = speedIn;
+    curve = _t->curve;
 }
 
 /**
@@ -74,21 +71,33 @@ Fashion::Transition::~Transition()
  */
 float Fashion::Transition::ratio(int _timestamp)
 {
-    float ret;
+    int elapsed, duration;
+    span(_timestamp, elapsed, duration);
+
+    return Easing::ratio(curve, elapsed, duration);
+}
 
+/**
+ * Get the progress of the transition regarding the timestamp (the Easing::ratio parameters)
+ * @param _timestamp is the current timestamp
+ * @param _elapsed is the time elapsed since the beginning of the transition (output)
+ * @param _duration is the duration of the transition (output)
+ */
+void Fashion::Transition::span(int _timestamp, int & _elapsed, int & _duration) const
+{
     _timestamp-=nbTimes*period;
 
-    if (_timestamp < timestampIn)   { ret = 0; }    else
-    if (_timestamp > timestampOut)  { ret = 1; }    else
+    // BEFORE THE TRANSITION THE RATIO IS 0, AFTER IT IS 1
+    if (_timestamp < timestampIn)   { _elapsed = 0; _duration = 1; }    else
+    if (_timestamp > timestampOut)  { _elapsed = 1; _duration = 1; }    else
     {
-        float t = (float) (_timestamp-timestampIn)/(timestampOut-timestampIn);
-        ret = a*t*t*t + b*t*t + c*t;
+        _elapsed    = _timestamp-timestampIn;
+        _duration   = timestampOut-timestampIn;
     }
-
-    return ret;
 }
 
-Fashion::Fashion(splashouille::Fashion * _fashion): timestamp(-1)
+Fashion::Fashion(splashouille::Fashion * _fashion):
+    next(0), order(0), timestamp(-1), duration(0), compiled(false), seeking(true), owner(0)
 {
     style = new Style(_fashion->getStyle());
     current = new Style(_fashion->getStyle());
@@ -96,7 +105,7 @@ Fashion::Fashion(splashouille::Fashion * _fashion): timestamp(-1)
     clone(_fashion);
 }
 
-Fashion::Fashion(): timestamp(-1)
+Fashion::Fashion(): next(0), order(0), timestamp(-1), duration(0), compiled(false), seeking(true), owner(0)
 {
     style = new Style();
     current = new Style();
@@ -112,33 +121,146 @@ Fashion::~Fashion()
     delete current;
     delete last;
 
-    for (std::list<Transition*>::iterator it=transitions.begin(); it!=transitions.end(); it++) { delete (*it); }
+    for (Transitions::iterator it=transitions.begin(); it!=transitions.end(); it++) { delete (*it); }
 }
 
 /**
- * Remove the old transitions by updating the initial style
+ * Build the property tracks from the transitions
+ */
+void Fashion::compile()
+{
+    for (int i=0; i<splashouille::Style::__last; i++) { tracks[i].clear(); }
+    periodic.clear();
+    duration = 0;
+
+    for (Transitions::const_iterator it=transitions.begin(); it!=transitions.end(); it++)
+    {
+        Transition * transition = *it;
+
+        if (transition->period>0) { periodic.push_back(transition); continue; }
+
+        if (transition->timestampOut-transition->start()>duration) { duration = transition->timestampOut-transition->start(); }
+        for (int i=0; i<splashouille::Style::__last; i++)
+        {
+            if (transition->style->getBitmap()&(1<<i)) { tracks[i].push_back(Key(transition->timestampOut, transition)); }
+        }
+    }
+
+    for (int i=0; i<splashouille::Style::__last; i++) { std::sort(tracks[i].begin(), tracks[i].end(), &Fashion::keyBefore); }
+    compiled = true;
+}
+
+/**
+ * Set the transitions state and the initial style at any timestamp without replaying the previous
+ * timestamps: the last finished transition of each property is found in its track (binary search)
  * @param _timestamp is the current timestamp
- * @param _active is set to true if a transaction is currently active
  */
-void Fashion::removeOldTransitions(int _timestamp, bool & _active)
+void Fashion::seek(int _timestamp)
 {
-    _active = false;
-    for (std::list<Transition*>::iterator it=transitions.begin(); it!=transitions.end(); it++)
+    Transition *    lasts[splashouille::Style::__last];
+    int             ends[splashouille::Style::__last];
+
+    if (!compiled) { compile(); }
+
+    // THE LAST FINISHED NOT PERIODIC TRANSITION OF EACH PROPERTY
+    for (int i=0; i<splashouille::Style::__last; i++)
+    {
+        Track::const_iterator it = std::upper_bound(tracks[i].begin(), tracks[i].end(), _timestamp, &Fashion::keyAfter);
+        lasts[i]    = (it!=tracks[i].begin())?(it-1)->transition:0;
+        ends[i]     = (it!=tracks[i].begin())?(it-1)->timestamp:0;
+    }
+
+    // THE PERIODIC TRANSITIONS ARE RUNNING SINCE THEIR START, THEIR LAST END IS COMPUTED FROM THE PERIOD
+    running.clear();
+    for (Transitions::const_iterator it=periodic.begin(); it!=periodic.end(); it++)
     {
         Transition * transition = *it;
+        if (transition->start()>_timestamp) { continue; }
+
+        transition->done    = false;
+        transition->nbTimes = (transition->timestampOut<=_timestamp)?
+                              (_timestamp-transition->timestampOut)/transition->period+1:0;
+        running.push_back(transition);
 
-        if (transition->timestampOut+transition->nbTimes*transition->period<=_timestamp && !transition->done)
+        int end = transition->timestampOut+(transition->nbTimes-1)*transition->period;
+        for (int i=0; transition->nbTimes && i<splashouille::Style::__last; i++)
+        {
+            if ((transition->style->getBitmap()&(1<<i)) &&
+                (!lasts[i] || end>ends[i] || (end==ends[i] && transition->order>lasts[i]->order)))
+            {
+                lasts[i] = transition; ends[i] = end;
+            }
+        }
+    }
+
+    for (int i=0; i<splashouille::Style::__last; i++) { if (lasts[i]) { style->add(lasts[i]->style, 1<<i); } }
+
+    // THE NOT PERIODIC TRANSITIONS IN PROGRESS STARTED LESS THAN THE LONGEST DURATION AGO
+    next = std::upper_bound(transitions.begin(), transitions.end(), _timestamp, &Fashion::startsAfter)-transitions.begin();
+    for (int i=next-1; i>=0 && transitions[i]->start()>_timestamp-duration; i--)
+    {
+        if (transitions[i]->period<=0 && transitions[i]->timestampOut>_timestamp) { running.push_back(transitions[i]); }
+    }
+    std::sort(running.begin(), running.end(), &Fashion::insertedBefore);
+
+    seeking = false;
+}
+
+/**
+ * Start a transition (keep the running transitions sorted by insertion)
+ * @param _transition is the transition
+ */
+void Fashion::run(Transition * _transition)
+{
+    running.insert(std::upper_bound(running.begin(), running.end(), _transition, &Fashion::insertedBefore), _transition);
+}
+
+/**
+ * Remove the old transitions by updating the initial style
+ * Only the started transitions are visited, the transitions in progress are stored in active
+ * @param _timestamp is the current timestamp
+ */
+void Fashion::removeOldTransitions(int _timestamp)
+{
+    // START THE TRANSITIONS REACHED SINCE THE LAST CALL
+    for (; next<transitions.size() && transitions[next]->start()<=_timestamp; next++) { run(transitions[next]); }
+
+    // THE FINISHED TRANSITIONS ARE ADDED IN THEIR INSERTION ORDER
+    active.clear();
+    unsigned int size = 0;
+    for (unsigned int i=0; i<running.size(); i++)
+    {
+        Transition * transition = running[i];
+
+        if (transition->timestampOut+transition->nbTimes*transition->period<=_timestamp)
         {
             style->add(transition->style);
-            if (transition->period) { transition->nbTimes++; } else { transition->done = true; }
+
+            // THE PERIODIC TRANSITIONS JUMP TO THE CURRENT REVOLUTION
+            if (transition->period>0)   { transition->nbTimes = (_timestamp-transition->timestampOut)/transition->period+1; }
+            else                        { transition->done = true; continue; }
         }
-        else
+
         if (transition->timestampIn+transition->nbTimes*transition->period<_timestamp &&
             transition->timestampOut+transition->nbTimes*transition->period>_timestamp )
         {
-            _active = true;
+            active.push_back(transition);
         }
+
+        running[size++] = transition;
     }
+    running.resize(size);
+}
+
+/**
+ * Set the object woken up by the changes of the fashion, of its initial style and of its transitions styles
+ * @param _owner is the object
+ */
+void Fashion::setOwner(Object * _owner)
+{
+    owner = _owner;
+    style->setOwner(_owner);
+    for (Transitions::const_iterator it=transitions.begin(); it!=transitions.end(); it++) { (*it)->style->setOwner(_owner); }
 }
 
 /**
@@ -150,8 +272,11 @@ void Fashion::clone(splashouille::Fashion * _fashion)
     style->copy(_fashion->getStyle());
     current->copy(_fashion->getStyle());
 
+    // THE PARENT TRANSITIONS ARE COPIED IN THEIR INSERTION ORDER
     splashouilleImpl::Fashion * fashion = static_cast<splashouilleImpl::Fashion *>(_fashion);
-    for (std::list<Transition*>::const_iterator it=fashion->getTransitions().begin(); it!=fashion->getTransitions().end(); it++)
+    Transitions                 parents(fashion->getTransitions());
+    std::sort(parents.begin(), parents.end(), &Fashion::insertedBefore);
+    for (Transitions::const_iterator it=parents.begin(); it!=parents.end(); it++)
     {
         addTransition(new Transition(*it));
     }
@@ -227,7 +352,18 @@ splashouille::Style * Fashion::importTransition(libconfig::Setting & _setting)
  */
 splashouille::Style * Fashion::addTransition(Transition * _transition)
 {
-    transitions.push_back(_transition);
+    Transitions::iterator it = std::upper_bound(transitions.begin(), transitions.end(), _transition, &Fashion::startsBefore);
+
+    // A TRANSITION ADDED BEFORE THE CURSOR HAS ALREADY STARTED
+    _transition->order = order++;
+    if (static_cast<unsigned int>(it-transitions.begin())<next) { run(_transition); next++; }
+    transitions.insert(it, _transition);
+    compiled = false;
+
+    // A SLEEPING OWNER HAS TO SEE THE NEW TRANSITION (AND THE LATER CHANGES OF ITS STYLE)
+    _transition->style->setOwner(owner);
+    if (owner) { owner->wake(); }
+
     return _transition->style;
 }
 
@@ -250,48 +386,174 @@ splashouille::Style * Fashion::addTransition(int _timestampIn, int _timestampOut
  * @param _timestamp is the current timestamp
  * @return the current style but const (because automaticaly generated)
  */
-splashouille::Style * Fashion::getStyle(int _timestamp)
+Style * Fashion::getStyle(int _timestamp)
+{
+    bool blended = prepare(_timestamp);
+    if (blended) { blend(); }
+
+    return commit(blended);
+}
+
+/**
+ * Prepare the computation of the current style: seek the transitions and remove the old ones
+ * @param _timestamp is the current timestamp
+ * @return true if the last style has to be blended with the active transitions (then committed)
+ */
+bool Fashion::prepare(int _timestamp)
 {
+    bool ret = false;
+
     if (timestamp!=_timestamp || !timestamp)
     {
-        bool active;
-        removeOldTransitions(_timestamp, active);
+        // AFTER A CLEAR, THE TRANSITIONS ARE NOT REPLAYED FROM THE BEGINNING
+        if (seeking) { seek(_timestamp); }
+        removeOldTransitions(_timestamp);
 
-        if (style->hasChangedSinceLastTime() || active)
+        if (style->hasChangedSinceLastTime() || !active.empty())
         {
             last->copy(style);
-            if (active)
-            {
-                for (std::list<Transition*>::iterator it=transitions.begin(); it!=transitions.end(); it++)
-                {
-                    Transition * transition = *it;
-                    if ( (transition->timestampIn+transition->nbTimes*transition->period<_timestamp) &&
-                         (transition->timestampOut+transition->nbTimes*transition->period>_timestamp) &&
-                         (!transition->done) )
-                    {
-                        last->mix(transition->style, transition->ratio(_timestamp));
-                    }
-                }
-            }
-            current->add(last);
+            ret = true;
         }
         timestamp = _timestamp;
     }
 
+    return ret;
+}
+
+/**
+ * Blend the active transitions into the last style one by one (see Batch for several fashions)
+ */
+void Fashion::blend()
+{
+    for (Transitions::iterator it=active.begin(); it!=active.end(); it++)
+    {
+        last->mix((*it)->style, (*it)->ratio(timestamp));
+    }
+}
+
+/**
+ * Commit the last style into the current style
+ * @param _blended is true if the last style has been blended (see prepare)
+ * @return the current style
+ */
+Style * Fashion::commit(bool _blended)
+{
+    if (_blended) { current->add(last); }
+
     return current;
 }
 
+/**
+ * Blend the active transitions of the fashions added to the batch (same result as Fashion::blend on each of them):
+ * the ratios of all the transitions are computed together, then the k-th mixes of all the fashions
+ */
+void Fashion::Batch::run()
+{
+    unsigned int size   = fashions.size();
+    unsigned int total  = 0;
+    unsigned int rounds = 0;
+
+    if (!size) { return; }
+
+    // THE ACTIVE TRANSITIONS OF ALL THE FASHIONS ARE LISTED ONE AFTER THE OTHER (THE BUFFERS ARE READ THROUGH POINTERS)
+    Fashion **      list    = &fashions[0];
+    first.resize(size+1);
+    unsigned int *  starts  = &first[0];
+    for (unsigned int i=0; i<size; i++)
+    {
+        unsigned int nb = list[i]->active.size();
+        starts[i]   = total;
+        total      += nb;
+        if (nb>rounds) { rounds = nb; }
+    }
+    starts[size] = total;
+    if (!total) { fashions.clear(); return; }
+
+    // THE RATIOS OF ALL THE ACTIVE TRANSITIONS
+    steps.resize(total); curves.resize(total); elapsed.resize(total); durations.resize(total); ratios.resize(total);
+    Transition **   all     = &steps[0];
+    const float **  samples = &curves[0];
+    int *           times   = &elapsed[0];
+    int *           lengths = &durations[0];
+    for (unsigned int i=0; i<size; i++)
+    {
+        if (starts[i]<starts[i+1])
+        {
+            std::copy(list[i]->active.begin(), list[i]->active.end(), all+starts[i]);
+            for (unsigned int j=starts[i]; j<starts[i+1]; j++)
+            {
+                all[j]->span(list[i]->timestamp, times[j], lengths[j]);
+                samples[j] = all[j]->getCurve();
+            }
+        }
+    }
+    Easing::ratios(samples, times, lengths, &ratios[0], total);
+
+    // THE MIXES OF A FASHION ARE SEQUENTIAL, THE MIXES OF DIFFERENT FASHIONS ARE INDEPENDENT
+    styles.resize(size); targets.resize(size); mixRatios.resize(size);
+    Style **        mixed   = &styles[0];
+    const Style **  mixing  = &targets[0];
+    float *         weights = &mixRatios[0];
+    const float *   results = &ratios[0];
+    for (unsigned int k=0; k<rounds; k++)
+    {
+        int nb = 0;
+        for (unsigned int i=0; i<size; i++)
+        {
+            unsigned int j = starts[i]+k;
+            if (j<starts[i+1])
+            {
+                mixed[nb]   = list[i]->last;
+                mixing[nb]  = all[j]->style;
+                weights[nb] = results[j];
+                nb++;
+            }
+        }
+        Style::mix(mixed, mixing, weights, nb, lanes);
+    }
+
+    fashions.clear();
+}
+
+/**
+ * Get the next timestamp the style changes at: the next transition start or boundary
+ * (to call after getStyle, the style does not change before)
+ * @return the timestamp (never if the style does not change anymore)
+ */
+int Fashion::getWakeTimestamp() const
+{
+    // A RUNNING MIX OR A PENDING CHANGE IS COMPUTED AT EACH TIMESTAMP
+    if (seeking || !active.empty() || style->hasChanged()) { return timestamp+1; }
+
+    int ret = (next<transitions.size())?transitions[next]->start():never;
+    for (unsigned int i=0; i<running.size(); i++)
+    {
+        // THE SLEEPING TRANSITION BECOMES ACTIVE AFTER ITS TIMESTAMP IN OR FINISHES AT ITS TIMESTAMP OUT
+        int in  = running[i]->timestampIn+running[i]->nbTimes*running[i]->period;
+        int out = running[i]->timestampOut+running[i]->nbTimes*running[i]->period;
+        if (in+1<ret)   { ret = in+1; }
+        if (out<ret)    { ret = out; }
+    }
+
+    return ret;
+}
+
 /**
  * Clear the transition regarding the new timestamp
  * @param _style is the new initial style
  */
 void Fashion::clear(splashouille::Style * _style)
 {
-    for (std::list<Transition*>::const_iterator it=transitions.begin(); it!=transitions.end(); it++)
+    for (Transitions::const_iterator it=transitions.begin(); it!=transitions.end(); it++)
     {
         (*it)->done = false;
         (*it)->nbTimes = 0;
     }
+    running.clear();
+    active.clear();
+    next = 0;
+    seeking = true;
+    if (owner) { owner->wake(); }
     if (_style)
     {
         style->copy(_style);
@@ -315,7 +577,7 @@ void Fashion::log(int _rank) const
     std::cout<<offset<<"+ Fashion"<<" (size: "<<transitions.size()<<")"<<std::endl;
     style->log(_rank);
 
-    for (std::list<Transition*>::const_iterator it=transitions.begin(); it!=transitions.end(); it++)
+    for (Transitions::const_iterator it=transitions.begin(); it!=transitions.end(); it++)
     {
         Transition * transition = *it;
         std::cout<<offset<<"+ Transition ["<<transition->timestampIn<<","<<transition->timestampOut<<"] ["<<transition->speedIn<<","<<
@@ -145,6 +145,7 @@ Image::Image(const std::string & _id, libconfig::Setting & _setting):
     splashouilleImpl::Object(_id), display(crop), original(0), tileset(0), tileIndex(-1)
 {
     type = TYPE_IMAGE;
+    setKind(this);
 
     // FASHION AND STYLE IMPORT
     Object::import(_setting);
@@ -249,6 +250,7 @@ Image::Image(const std::string & _id, Image * _image):
     splashouilleImpl::Object(_id), display(crop), original(0), tileset(0), tileIndex(-1)
 {
     type        = TYPE_IMAGE;
+    setKind(this);
     setFilename(_image->getFilename());
 
     tileset = _image->getTileset();
@@ -263,6 +265,7 @@ Image::Image(const std::string & _id, Image * _image):
 Image::Image(const std::string & _id): splashouilleImpl::Object(_id), tileset(0), tileIndex(-1)
 {
     type        = TYPE_IMAGE;
+    setKind(this);
     original    = 0;
     surface     = 0;
 }
@@ -299,12 +302,14 @@ Image::~Image()
  */
 void Image::setTileIndex(int _tileIndex)
 {
+    wake();
     if (tileset && tileset->tiles[_tileIndex])
     {
         if (_tileIndex!=tileIndex)
         {
             // SAVE THE CURRENT STYLE
             Fashion * newFashion = new Fashion();
+            newFashion->setOwner(this);
             newFashion->getStyle()->copy(fashion->getStyle());
 
             // REMOVE THE OLD FASHIONS
@@ -312,10 +317,10 @@ void Image::setTileIndex(int _tileIndex)
             fashions.clear();
 
             // BUILD A NEW FASHION
-            fashionId           = "default";
+            fashionSymbol       = symbolDefault;
             fashion             = newFashion;
             initialTimestamp    = -1;
-            fashions.insert(std::pair<std::string, Fashion*>(fashionId, fashion));
+            fashions.insert(std::pair<int, Fashion*>(fashionSymbol, fashion));
 
             Tileset::Tile * tile = tileset->tiles[_tileIndex];
 
@@ -355,53 +360,68 @@ void Image::setTileIndex(int _tileIndex)
     }
 }
 
- /**
-  * Render the object into the surface canvas
-  * @param _surface is the surface to fill
-  * @param _offset is the parent offset
-  * @return true
-  */
+/**
+ * Render the object into the surface canvas
+ * @param _surface is the surface to fill
+ * @param _offset is the parent offset
+ * @return true
+ */
 bool Image::render(SDL_Surface * _surface, SDL_Rect * _offset)
 {
-    const splashouille::Style * style = fashion->getCurrent();
+    DisplayList::Command command;
+    if (compile(_surface, _offset, &command)) { DisplayList::blit(_surface, command); }
+    return true;
+}
 
-    // UPDATE THE SDL_RECT POSITION IF NECESSARY
-    if (style->getDisplay() && surface)
-    {
-        SDL_SetAlpha(surface, SDL_SRCALPHA | SDL_RLEACCEL, style->getOpacity());
+/**
+ * Prepare the render of the object and get its blit command
+ * @param _surface is the surface to fill
+ * @param _offset is the parent offset
+ * @param _command is the blit command (output)
+ * @return true if there is something to blit
+ */
+bool Image::compile(SDL_Surface * _surface UNUSED, SDL_Rect * _offset, DisplayList::Command * _command)
+{
+    bool            ret     = false;
+    const Style *   style   = fashion->getCurrent();
 
-        // HANDLE THE POSITION REGARDING THE PARENT OFFSET (IF ANY)
-        SDL_Rect vPosition;
-        SDL_Rect vSource;
-        splashouille::Engine::copy(&vPosition, position);
-        splashouille::Engine::copy(&vSource, source);
-        if (_offset) {
-            splashouille::Engine::offset(&vPosition, _offset);
+    // HANDLE THE OPACITY AND THE POSITION REGARDING THE PARENT OFFSET (IF ANY)
+    if (style->isDisplayed() && surface)
+    {
+        _command->surface   = surface;
+        _command->alpha     = style->getAlpha();
+        ret                 = DisplayList::place(position, source, _offset, _command);
+    }
 
-            if (vPosition.y<_offset->y)
-            {
-                if (vPosition.h>(_offset->y-vPosition.y)) { vPosition.h-=(_offset->y-vPosition.y); } else { vPosition.h = 0; }
-                vSource.y-=(vPosition.y-_offset->y);
-                vPosition.y = _offset->y;
-            }
+    return ret;
+}
 
-            if (vPosition.x<_offset->x)
-            {
-                if (vPosition.w>(_offset->x-vPosition.x)) { vPosition.w-=(_offset->x-vPosition.x); } else { vPosition.w = 0; }
-                vSource.x-=(vPosition.x-_offset->x);
-                vPosition.x = _offset->x;
-            }
+/**
+ * Get the area fully covered by the image when it is rendered (used for the occlusion)
+ * @param _rect is the opaque area in the parent coordinates (output)
+ * @return true if the image is opaque on a not empty area
+ */
+bool Image::getOpaqueRect(SDL_Rect * _rect)
+{
+    const Style * style = fashion->getCurrent();
 
-            vSource.w = vPosition.w;
-            vSource.h = vPosition.h;
-        }
+    // NEITHER COLORKEY NOR PER-PIXEL ALPHA
+    bool ret = style->getAlpha()>=255 && surface && !(surface->flags&SDL_SRCCOLORKEY) &&
+               !surface->format->Amask && source->x>=0 && source->y>=0;
 
-        // DRAW THE IMAGE
-        if (vPosition.w>0 && vPosition.h>0) { SDL_BlitSurface(surface, &vSource, _surface, &vPosition); }
+    if (ret)
+    {
+        // THE BLIT IS LIMITED BY THE IMAGE SIZE
+        int w = surface->w-source->x; if (w>position->w) { w = position->w; }
+        int h = surface->h-source->y; if (h>position->h) { h = position->h; }
+        _rect->x = position->x;
+        _rect->y = position->y;
+        _rect->w = w>0?w:0;
+        _rect->h = h>0?h:0;
+        ret = (_rect->w && _rect->h);
     }
 
-
-    return true;
+    return ret;
 }
 
 /**
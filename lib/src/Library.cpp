@@ -34,12 +34,12 @@ using namespace splashouilleImpl;
 
 int Library::nbObjects = 0;
 
-Library::Library():listener(0) {}
+Library::Library():listener(0), revision(0) {}
 
 Library::~Library()
 {
     listener = 0;
-    for (std::map<std::string, splashouille::Object *>::iterator it = library.begin(); it != library.end(); it++)
+    for (ObjectMap::iterator it = library.begin(); it != library.end(); it++)
     {
         deleteObject(it, false);
     }
@@ -74,14 +74,14 @@ splashouille::Object * Library::createObject(libconfig::Setting & _setting)
 {
     std::string             type;       // Type of the object
     std::string             id;         // Object id
-    splashouille::Object *  ret = 0;    // Object pointer (0 if failed)
+    Object *                ret = 0;    // Object pointer (0 if failed)
 
     if (_setting.exists(DEFINITION_ID))  { _setting.lookupValue(DEFINITION_ID, id); }
     else                                 { char m[128]; snprintf(m, 128, "__object%05d", nbObjects++); id.assign(m); }
 
     if (id.size())
     {
-        if (!(ret=getObjectById(id)))
+        if (!(ret=getObjectBySymbol(Symbol::find(id))))
         {
             _setting.lookupValue(TYPE, type);
 
@@ -118,7 +118,7 @@ splashouille::Object * Library::createObject(const std::string & _id, const std:
 
 splashouille::Solid * Library::createSolid(const std::string & _id)
 {
-    splashouille::Solid * ret = new splashouilleImpl::Solid(_id);
+    splashouilleImpl::Solid * ret = new splashouilleImpl::Solid(_id);
     if (ret) { insertObject(_id, ret); }
 
     if (Engine::debug)
@@ -132,7 +132,7 @@ splashouille::Solid * Library::createSolid(const std::string & _id)
 
 splashouille::Image * Library::createImage(const std::string & _id)
 {
-    splashouille::Image * ret = new splashouilleImpl::Image(_id);
+    splashouilleImpl::Image * ret = new splashouilleImpl::Image(_id);
     if (ret) { insertObject(_id, ret); }
 
 
@@ -147,7 +147,7 @@ splashouille::Image * Library::createImage(const std::string & _id)
 
 splashouille::Animation * Library::createAnimation(const std::string & _id)
 {
-    splashouille::Animation * ret = new splashouilleImpl::Animation(_id, this);
+    splashouilleImpl::Animation * ret = new splashouilleImpl::Animation(_id, this);
     if (ret) { insertObject(_id, ret); }
 
     if (Engine::debug)
@@ -161,7 +161,7 @@ splashouille::Animation * Library::createAnimation(const std::string & _id)
 
 splashouille::Sound * Library::createSound(const std::string & _id)
 {
-    splashouille::Sound * ret = new splashouilleImpl::Sound(_id);
+    splashouilleImpl::Sound * ret = new splashouilleImpl::Sound(_id);
     if (ret) { insertObject(_id, ret); }
 
     if (Engine::debug)
@@ -175,7 +175,7 @@ splashouille::Sound * Library::createSound(const std::string & _id)
 
 splashouille::Map * Library::createMap(const std::string & _id)
 {
-    splashouille::Map * ret = new splashouilleImpl::Map(_id, this);
+    splashouilleImpl::Map * ret = new splashouilleImpl::Map(_id, this);
     if (ret) { insertObject(_id, ret); }
 
     if (Engine::debug)
@@ -195,39 +195,26 @@ splashouille::Map * Library::createMap(const std::string & _id)
  */
 splashouille::Object *  Library::copyObject(const std::string & _parent, const std::string & _id)
 {
-    splashouille::Object * ret = 0;
+    Object * ret    = getObjectBySymbol(Symbol::find(_id));
+    Object * parent = getObjectBySymbol(Symbol::find(_parent));
 
-    if (!(ret=getObjectById(_id)))
+    if (!ret && parent)
     {
-        splashouille::Object * parent = getObjectById(_parent);
-        if (parent)
+        switch (parent->kind)
         {
-            if (! parent->getType().compare(TYPE_SOLID))
-            {
-                ret = new splashouilleImpl::Solid(_id, dynamic_cast<splashouilleImpl::Solid*>(parent));
-            }
-            else if (! parent->getType().compare(TYPE_IMAGE))
-            {
-                ret = new splashouilleImpl::Image(_id, dynamic_cast<splashouilleImpl::Image*>(parent));
-            }
-            else if (! parent->getType().compare(TYPE_ANIMATION))
-            {
-                ret = new splashouilleImpl::Animation(_id, dynamic_cast<splashouilleImpl::Animation*>(parent), this);
-            }
-            else if (! parent->getType().compare(TYPE_SOUND))
-            {
-                ret = new splashouilleImpl::Sound(_id, dynamic_cast<splashouilleImpl::Sound*>(parent));
-            }
-            else if (! parent->getType().compare(TYPE_MAP))
-            {
-                ret = new splashouilleImpl::Map(_id, dynamic_cast<splashouilleImpl::Map*>(parent), this);
-            }
-
-            if (ret) { insertObject(_id, ret); }
+        case Object::kindSolid:     ret = new splashouilleImpl::Solid(_id, parent->concrete.solid);                 break;
+        case Object::kindImage:     ret = new splashouilleImpl::Image(_id, parent->concrete.image);                 break;
+        case Object::kindAnimation: ret = new splashouilleImpl::Animation(_id, parent->concrete.animation, this);   break;
+        case Object::kindSound:     ret = new splashouilleImpl::Sound(_id, parent->concrete.sound);                 break;
+        case Object::kindMap:       ret = new splashouilleImpl::Map(_id, parent->concrete.map, this);               break;
+        default:                    break;
         }
+
+        if (ret) { insertObject(_id, ret); }
     }
 
-    if (ret && ret->getType().compare(getObjectById(_parent)->getType())) { ret = 0; }
+    // AN EXISTING OBJECT IS RETURNED ONLY IF IT HAS THE SAME TYPE AS THE PARENT
+    if (ret && (!parent || ret->kind!=parent->kind)) { ret = 0; }
 
     if (Engine::debug)
     {
@@ -245,35 +232,38 @@ splashouille::Object *  Library::copyObject(const std::string & _parent, const s
  * @param _erase the iterator from the map
  * @return true if success
  */
-bool Library::deleteObject(const std::map<std::string, splashouille::Object *>::iterator & _it, bool _erase)
+bool Library::deleteObject(const ObjectMap::iterator & _it, bool _erase)
 {
     bool ret = (_it!=library.end());
     if (ret)
     {
-        splashouille::Object * obj = _it->second;
+        Object * obj = _it->second;
 
         // Listener onDelete callback
         if (listener) { listener->onDelete(obj); }
 
         if (!obj->isEngine())
         {
-            if (obj->isSolid())     { delete(dynamic_cast<splashouilleImpl::Solid*>(obj)); }    else
-            if (obj->isImage())     { delete(dynamic_cast<splashouilleImpl::Image*>(obj)); }    else
-            if (obj->isAnimation()) { delete(dynamic_cast<splashouilleImpl::Animation*>(obj));} else
-            if (obj->isSound())     { delete(dynamic_cast<splashouilleImpl::Sound*>(obj)); }    else
-            if (obj->isMap())       { delete(dynamic_cast<splashouilleImpl::Map*>(obj)); }      else
-                                    { ret = false; }
+            switch (obj->kind)
+            {
+            case Object::kindSolid:     delete obj->concrete.solid;     break;
+            case Object::kindImage:     delete obj->concrete.image;     break;
+            case Object::kindAnimation: delete obj->concrete.animation; break;
+            case Object::kindSound:     delete obj->concrete.sound;     break;
+            case Object::kindMap:       delete obj->concrete.map;       break;
+            default:                    ret = false;                    break;
+            }
         }
     }
     // Log the operation
     if (Engine::debug)
     {
         std::cout<<std::setw(STD_LABEL)<<std::left<<"Library::deleteObject"
-             <<" (id: "<<_it->first<<") (return: "<<(ret?"OK":"KO")<<")"<<std::endl;
+             <<" (id: "<<(_it!=library.end()?Symbol::getName(_it->first):"")<<") (return: "<<(ret?"OK":"KO")<<")"<<std::endl;
     }
 
-    // If ok delete the entry in the library
-    if (ret && _erase) { library.erase(_it); }
+    // If ok delete the entry in the library (the objects bound to the events are not valid anymore)
+    if (ret && _erase) { library.erase(_it); revision++; }
 
     return ret;
 }
@@ -285,7 +275,7 @@ bool Library::deleteObject(const std::map<std::string, splashouille::Object *>::
  */
 bool Library::deleteObject(const std::string & _id)
 {
-    return deleteObject(library.find(_id));
+    return deleteObject(library.find(Symbol::find(_id)));
 }
 
 /**
@@ -295,12 +285,9 @@ bool Library::deleteObject(const std::string & _id)
  */
 bool Library::deleteObject(splashouille::Object * _obj)
 {
-    // Find the object in the library
-    std::map<std::string, splashouille::Object *>::iterator it;
-    for (it = library.begin(); it!=library.end(); it++)
-    {
-        if (it->second==_obj) break;
-    }
+    // Find the object in the library (the objects are always inserted with their id as key)
+    ObjectMap::iterator it = _obj?library.find(Symbol::find(_obj->getId())):library.end();
+    if (it!=library.end() && static_cast<splashouille::Object*>(it->second)!=_obj) { it = library.end(); }
 
     return deleteObject(it);
 }
@@ -311,10 +298,11 @@ bool Library::deleteObject(splashouille::Object * _obj)
  * @param _object is the object to insert
  * @return true if succeed
  */
-bool Library::insertObject(const std::string & _key, splashouille::Object * _object)
+bool Library::insertObject(const std::string & _key, Object * _object)
 {
-    std::pair<std::map<std::string, splashouille::Object *>::iterator, bool> ret;
-    ret = library.insert(std::pair<std::string, splashouille::Object *>(_key, _object));
+    std::pair<ObjectMap::iterator, bool> ret;
+    ret = library.insert(std::pair<int, Object *>(Symbol::get(_key), _object));
+    if (ret.second) { revision++; }
 
     if (listener) { listener->onCreate(_object); }
 
@@ -322,40 +310,34 @@ bool Library::insertObject(const std::string & _key, splashouille::Object * _obj
 }
 
 
+splashouille::Object * Library::getObjectById(const std::string & _id) const
+{
+    return getObjectBySymbol(Symbol::find(_id));
+}
 splashouille::Solid * Library::getSolidById(const std::string & _id) const
 {
-    splashouille::Solid *       ret = 0;
-    splashouille::Object *      obj = getObjectById(_id);
-    if (obj && !obj->getType().compare(TYPE_SOLID)) { ret = dynamic_cast<splashouille::Solid*>(obj); }
-    return ret;
+    Object * obj = getObjectBySymbol(Symbol::find(_id));
+    return (obj && obj->kind==Object::kindSolid)?obj->concrete.solid:0;
 }
 splashouille::Image * Library::getImageById(const std::string & _id) const
 {
-    splashouille::Image *       ret = 0;
-    splashouille::Object *      obj = getObjectById(_id);
-    if (obj && !obj->getType().compare(TYPE_IMAGE)) { ret = dynamic_cast<splashouille::Image*>(obj); }
-    return ret;
+    Object * obj = getObjectBySymbol(Symbol::find(_id));
+    return (obj && obj->kind==Object::kindImage)?obj->concrete.image:0;
 }
 splashouille::Animation * Library::getAnimationById(const std::string & _id) const
 {
-    splashouille::Animation *   ret = 0;
-    splashouille::Object *      obj = getObjectById(_id);
-    if (obj && !obj->getType().compare(TYPE_ANIMATION)) { ret = dynamic_cast<splashouille::Animation*>(obj); }
-    return ret;
+    Object * obj = getObjectBySymbol(Symbol::find(_id));
+    return (obj && obj->kind==Object::kindAnimation)?obj->concrete.animation:0;
 }
 splashouille::Sound * Library::getSoundById(const std::string & _id) const
 {
-    splashouille::Sound *       ret = 0;
-    splashouille::Object *      obj = getObjectById(_id);
-    if (obj && !obj->getType().compare(TYPE_SOUND)) { ret = dynamic_cast<splashouille::Sound*>(obj); }
-    return ret;
+    Object * obj = getObjectBySymbol(Symbol::find(_id));
+    return (obj && obj->kind==Object::kindSound)?obj->concrete.sound:0;
 }
 splashouille::Map * Library::getMapById(const std::string & _id) const
 {
-    splashouille::Map *         ret = 0;
-    splashouille::Object *      obj = getObjectById(_id);
-    if (obj && !obj->getType().compare(TYPE_MAP)) { ret = dynamic_cast<splashouille::Map*>(obj); }
-    return ret;
+    Object * obj = getObjectBySymbol(Symbol::find(_id));
+    return (obj && obj->kind==Object::kindMap)?obj->concrete.map:0;
 }
 
 /**
@@ -364,9 +346,9 @@ splashouille::Map * Library::getMapById(const std::string & _id) const
 void Library::log() const
 {
     std::cout<<"+ Library (size: "<<library.size()<<")"<<std::endl;
-    for (std::map<std::string, splashouille::Object *>::const_iterator it = library.begin(); it != library.end(); it++)
+    for (ObjectMap::const_iterator it = library.begin(); it != library.end(); it++)
     {
-        std::cout<<"    ["<<it->first<<"]"<<std::endl;
+        std::cout<<"    ["<<Symbol::getName(it->first)<<"]"<<std::endl;
         it->second->log(1);
     }
 }
@@ -36,13 +36,14 @@ Map::Map(const std::string & _id, libconfig::Setting & _setting, splashouille::L
     splashouilleImpl::Object(_id), library(_library), map(0), mode(ortho), first(true)
 {
     type = TYPE_MAP;
+    setKind(this);
     size[0] = size[1] = 1;
     size[2] = size[3] = 16;
 
     // TAG VALUE BY DEFAULT
     char msgtmp[128];
     snprintf(msgtmp, 128, "map%03d", counter++);
-    tag.assign(msgtmp);
+    setTag(msgtmp);
 
     // FASHION AND STYLE IMPORT
     Object::import(_setting);
@@ -87,6 +88,7 @@ Map::Map(const std::string & _id, Map * _map, splashouille::Library * _library)
     splashouilleImpl::Object(_id), library(_library), map(0), mode(ortho), first(true)
 {
     type = TYPE_MAP;
+    setKind(this);
     size[0] = size[1] = 1;
     size[2] = size[3] = 16;
 
@@ -100,6 +102,7 @@ Map::Map(const std::string & _id, splashouille::Library * _library) :
     splashouilleImpl::Object(_id), library(_library), map(0), mode(ortho), first(true)
 {
     type = TYPE_MAP;
+    setKind(this);
     size[0] = size[1] = 1;
     size[2] = size[3] = 16;
 
@@ -225,7 +228,8 @@ bool Map::update(int _timestamp)
         getLimits(style, &current);
         getLimits(&lastStyle, &last);
 
-        // INSERT THE NEW TILES INSIDE THE VIEW
+        // INSERT THE NEW TILES INSIDE THE VIEW (ALL AT ONCE)
+        toInsert.clear();
         switch(mode)
         {
         case ortho:
@@ -237,10 +241,10 @@ bool Map::update(int _timestamp)
                 snprintf(msg, 128, "%s%05d%05d", getId().c_str(), i, j);
                 splashouilleImpl::Image * img = dynamic_cast<splashouilleImpl::Image*>(library->copyObject(tileset->getId(), msg));
                 img->setTileIndex(map[i+j*size[0]]);
-                img->setTag(getTag());
+                img->tagSymbol = tagSymbol;
                 img->setZIndex(getZIndex()+j);
                 img->setState(i+j*size[0]);
-                crowd->insertObject(initialTimestamp, img);
+                toInsert.push_back(img);
             }
             break;
         case iso:
@@ -253,22 +257,24 @@ bool Map::update(int _timestamp)
                 snprintf(msg, 128, "%s%05d%05d", getId().c_str(), i, j);
                 splashouilleImpl::Image * img = dynamic_cast<splashouilleImpl::Image*>(library->copyObject(tileset->getId(), msg));
                 img->setTileIndex(map[i+j*size[0]]);
-                img->setTag(getTag());
+                img->tagSymbol = tagSymbol;
                 img->setZIndex(getZIndex()+i+j);
                 img->setState(i+j*size[0]);
-                crowd->insertObject(initialTimestamp, img);
+                toInsert.push_back(img);
             }
             break;
         };
 
+        crowd->insertObjects(initialTimestamp, toInsert);
+
         toDelete.clear();
-        crowd->forEach(this, getTag(), true, updateTiles);
+        crowd->forEach(this, tagSymbol, true, updateTiles);
         first = false;
 
         // REMOVE OUT TILES
         while (toDelete.size())
         {
-            crowd->dropObject(toDelete.front()->getId());
+            crowd->dropObject(toDelete.front());
             library->deleteObject(toDelete.front());
             toDelete.pop_front();
         };
@@ -288,11 +294,11 @@ bool Map::update(int _timestamp)
 bool Map::outCrowd()
 {
     toDelete.clear();
-    crowd->forEach(this, getTag(), true, removeTiles);
+    crowd->forEach(this, tagSymbol, true, removeTiles);
 
     while (toDelete.size())
     {
-        crowd->dropObject(toDelete.front()->getId());
+        crowd->dropObject(toDelete.front());
         library->deleteObject(toDelete.front());
         toDelete.pop_front();
     };
@@ -21,6 +21,7 @@ SPLASHOUILLE.  If not, see http://www.gnu.org/licenses/
 #include <splashouilleImpl/Fashion.hpp>
 #include <splashouilleImpl/Style.hpp>
 #include <splashouilleImpl/Image.hpp>
+#include <splashouilleImpl/Crowd.hpp>
 
 #include <libconfig.h++>
 #include <SDL.h>
@@ -33,16 +34,26 @@ using namespace splashouilleImpl;
 
 int Object::garbageNumber = 0;
 
+const int Object::symbolDefault = Symbol::get("default");
+
+/** The symbols of the mouse fashions */
+static const int symbolMouseOver    = Symbol::get("mouseover");
+static const int symbolMouseClick   = Symbol::get("mouseclick");
+static const int symbolMouseOut     = Symbol::get("mouseout");
+
 Object::Object(const std::string & _id):
-    surface(0), id(_id), tag("default"), initialTimestamp(0), zIndex(0), state(0), nbUpdates(0), mouseOver(false),
+    kind(kindObject), surface(0), id(_id), idSymbol(Symbol::get(_id)), fashionSymbol(symbolDefault), tagSymbol(symbolDefault),
+    initialTimestamp(0), zIndex(0), state(0), nbUpdates(0), mouseOver(false), crowdZIndex(0), crowdSequence(0),
+    container(0), wakeStamp(0), awake(false),
     listener(0), associatedData(0)
 {
+    concrete.solid = 0;
     source      = new SDL_Rect();
     position    = new SDL_Rect();
     updateArea  = new SDL_Rect();
     fashion     = new Fashion();
-    fashionId   = "default";
-    fashions.insert(std::pair<std::string, Fashion*>(fashionId, fashion));
+    fashion->setOwner(this);
+    fashions.insert(std::pair<int, Fashion*>(fashionSymbol, fashion));
 
     source->x = source->y = source->w = source->h = 0;
     clearPosition();
@@ -52,6 +63,9 @@ Object::Object(const std::string & _id):
 
 Object::~Object()
 {
+    // A DELETED OBJECT DOES NOT STAY IN ITS CROWD
+    if (container) { container->forget(this); }
+
     delete source;
     delete position;
     delete updateArea;
@@ -77,11 +91,13 @@ bool Object::import(libconfig::Setting & _setting)
             for (int i=_setting[FASHIONS].getLength()-1; i>=0; i--)
             {
                 libconfig::Setting & setting = _setting[FASHIONS][i];
+                std::string fashionId;
                 fashion = new Fashion();
+                fashion->setOwner(this);
                 fashion->import(setting[FASHION]);
 
-                setting.lookupValue(FASHION_ID, fashionId);
-                fashions.insert(std::pair<std::string, Fashion*>(fashionId, fashion));
+                if (setting.lookupValue(FASHION_ID, fashionId)) { fashionSymbol = Symbol::get(fashionId); }
+                fashions.insert(std::pair<int, Fashion*>(fashionSymbol, fashion));
             }
         }
         catch(libconfig::SettingTypeException e) { }
@@ -117,7 +133,7 @@ bool Object::import(libconfig::Setting & _setting)
     if (_setting.exists(DEFINITION_ZINDEX))     { _setting.lookupValue(DEFINITION_ZINDEX, zIndex); }
 
     // HANDLE THE TAG
-    if (_setting.exists(DEFINITION_TAG))        { _setting.lookupValue(DEFINITION_TAG, tag); }
+    if (_setting.exists(DEFINITION_TAG))        { std::string tag; _setting.lookupValue(DEFINITION_TAG, tag); setTag(tag); }
 
     // HANDLE THE CALLBACK VALUE
     if (_setting.exists(DEFINITION_STATE))      { _setting.lookupValue(DEFINITION_STATE, state); }
@@ -151,26 +167,36 @@ bool Object::import(libconfig::Setting & _setting)
  */
 bool Object::changeFashion(const std::string & _fashionId, bool _force)
 {
-    bool ret = false;
+    int fashionSymbolNew = Symbol::find(_fashionId);
+    return (fashionSymbolNew!=Symbol::none && changeFashion(fashionSymbolNew, _force));
+}
+
+/**
+ * Change the current fashion
+ * @param _fashionSymbol is the fashion Id as symbol
+ * @param _force is true than change fashion even if it is the same
+ * @return true if the fashion is found
+ */
+bool Object::changeFashion(int _fashionSymbol, bool _force)
+{
+    bool                ret = false;
+    FashionMap::iterator vIt = fashions.find(_fashionSymbol);
 
-    for (FashionMap::iterator vIt=fashions.begin(); vIt!=fashions.end(); vIt++)
+    if (vIt!=fashions.end() && (_force || vIt->second!=fashion))
     {
-        if (!vIt->first.compare(_fashionId) && (_force || vIt->second!=fashion))
-        {
-            ret = true;
-            initialTimestamp = -1;
-            splashouille::Style * style = fashion->getStyle();
-            fashionId=_fashionId;
-            fashion = vIt->second;
-            fashion->clear(style);
-        }
+        ret = true;
+        initialTimestamp = -1;
+        wake();
+        splashouille::Style * style = fashion->getStyle();
+        fashionSymbol = _fashionSymbol;
+        fashion = vIt->second;
+        fashion->clear(style);
     }
 
-
     if (Engine::debug && ret)
     {
         std::cout<<std::setw(STD_LABEL)<<std::left<<"Object::changeFashion"<<" (id: "<<getId()<<
-                 ") (fashion: "<<fashionId<<")"<<std::endl;
+                 ") (fashion: "<<getFashionId()<<")"<<std::endl;
     }
 
     return ret;
@@ -188,10 +214,12 @@ void Object::cloneFashion(Object * _object)
     for (FashionMap::iterator vIt=_object->fashions.begin(); vIt!=_object->fashions.end(); vIt++)
     {
         Fashion * fashionTmp = new Fashion();
+        fashionTmp->setOwner(this);
         fashionTmp->clone(vIt->second);
-        fashions.insert(std::pair<std::string, Fashion*>(vIt->first, fashionTmp));
-        if (vIt->second == _object->fashion) { fashion = fashionTmp; fashionId = vIt->first; }
+        fashions.insert(std::pair<int, Fashion*>(vIt->first, fashionTmp));
+        if (vIt->second == _object->fashion) { fashion = fashionTmp; fashionSymbol = vIt->first; }
     }
+    wake();
 }
 
 /**
@@ -206,6 +234,27 @@ splashouille::Fashion * Object::getFashion()    { return fashion; }
  */
 splashouille::Style * Object::getStyle()        { return fashion->getStyle(); }
 
+/**
+ * Schedule the object for the next update of its crowd (its style or its fashion may have been changed)
+ */
+void Object::wake()
+{
+    if (container && !awake) { container->wake(this); }
+}
+
+/**
+ * Get the next timestamp the object changes at (to call after the update)
+ * @return the timestamp (Fashion::never if the object does not change by itself)
+ */
+int Object::getWakeTimestamp() const
+{
+    // A RESTARTED OBJECT (NEW FASHION) IS UPDATED AT ONCE
+    if (initialTimestamp<0) { return -Fashion::never; }
+
+    int ret = fashion->getWakeTimestamp();
+    return (ret!=Fashion::never)?initialTimestamp+ret:ret;
+}
+
 /**
  * Get the position of the object
  * @param x,y,w,h are the coordinates of the object
@@ -247,21 +296,21 @@ bool Object::mouseEvent(int _timestampInMilliSeconds, int _x, int _y, bool _chec
 
     if (_x>=position->x && _x<=position->x+position->w && _y>=position->y && _y<=position->y+position->h && _checkOver)
     {
-        if (getStyle()->getDisplay())
+        if (fashion->getStyle()->getDisplay())
         {
             ret = false;
 
             if (beginWithMouse(getFashionId()))
             {
                 // CHANGE THE FASHION IF NECESSARY
-                std::string newFashionId = _state?"mouseclick":"mouseover";
-                if (newFashionId.compare(fashionId))
+                int fashionSymbolNew = _state?symbolMouseClick:symbolMouseOver;
+                if (fashionSymbolNew!=fashionSymbol)
                 {
-                    bool release = (!fashionId.compare("mouseclick"));
-                    changeFashion(newFashionId);
+                    bool release = (fashionSymbol==symbolMouseClick);
+                    changeFashion(fashionSymbolNew);
                     if (listener)
                     {
-                        if (release || !newFashionId.compare("mouseclick"))
+                        if (release || fashionSymbolNew==symbolMouseClick)
                             { ret = listener->onMouseClick(_timestampInMilliSeconds, this, _x, _y, _state, release); }
                         else
                             { ret = listener->onMouseOver(_timestampInMilliSeconds, this, _x, _y); }
@@ -269,7 +318,7 @@ bool Object::mouseEvent(int _timestampInMilliSeconds, int _x, int _y, bool _chec
                 }
 
                 // THE TRANSPARENCY FORWARDS THE EVENT
-                ret |= (getStyle()->getOpacity()!=255);
+                ret |= (fashion->getStyle()->getOpacity()!=255);
             }
             mouseOver = true;
         }
@@ -278,7 +327,7 @@ bool Object::mouseEvent(int _timestampInMilliSeconds, int _x, int _y, bool _chec
     if (mouseOver || !_checkOver )
     {
         mouseOver = false;
-        if (beginWithMouse(getFashionId())) { changeFashion("mouseout"); }
+        if (beginWithMouse(getFashionId())) { changeFashion(symbolMouseOut); }
         if (listener) { listener->onMouseOut(_timestampInMilliSeconds, this); }
     }
     return ret;
@@ -300,6 +349,19 @@ void Object::clearPosition()
  * @return true if has changed
  */
 bool Object::update( int _timestamp)
+{
+    bool blended = prepareUpdate(_timestamp);
+    if (blended) { fashion->blend(); }
+
+    return finishUpdate(blended);
+}
+
+/**
+ * Start the update of the object: prepare the current style of its fashion
+ * @param _timestamp is the current timestamp
+ * @return true if the style has to be blended (see Fashion::prepare)
+ */
+bool Object::prepareUpdate(int _timestamp)
 {
     // Handle the initial timestamp
     if (initialTimestamp<0) { initialTimestamp=_timestamp; }
@@ -307,28 +369,24 @@ bool Object::update( int _timestamp)
     int localTimestamp = _timestamp - initialTimestamp;
     if (localTimestamp<0) { localTimestamp=0; }
 
+    return fashion->prepare(localTimestamp);
+}
+
+/**
+ * End the update of the object once its style is blended
+ * @param _blended is the result of prepareUpdate
+ * @return true if the object has changed
+ */
+bool Object::finishUpdate(bool _blended)
+{
     // Get the current style
     int ret = 0;
-    splashouille::Style * style = fashion->getStyle(localTimestamp);
+    Style * style = fashion->commit(_blended);
 
     if ((ret = style->hasChangedSinceLastTime()))
     {
         splashouille::Engine::copy(updateArea, position);
-
-        position->x = style->getLeft() + style->getRelativeLeft();
-        position->y = style->getTop() + style->getRelativeTop();
-        position->w = style->getWidth();
-        position->h = style->getHeight();
-
-        float p[2];
-        style->getPosition(p[0], p[1]);
-        source->x = p[0];
-        source->y = p[1];
-        source->w = position->w;
-        source->h = position->h;
-
-        splashouille::Engine::add(updateArea, position);
-
+        style->getArea(position, source);
     }
 
     nbUpdates++;
@@ -0,0 +1,358 @@
+/*
+Copyright 2011 JohannC
+
+This file is part of SPLASHOUILLE.
+
+SPLASHOUILLE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+SPLASHOUILLE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+SPLASHOUILLE.  If not, see http://www.gnu.org/licenses/
+*/
+
+#include <splashouilleImpl/Region.hpp>
+#include <splashouilleImpl/ThreadPool.hpp>
+
+using namespace splashouilleImpl;
+
+/** The pool of update rects arrays, by size (nbRectsMin<<index) */
+const static int                nbRectsPools    = 9;
+static std::vector<SDL_Rect*>   rectsPool[nbRectsPools];
+
+/**
+ * Get an array from the pool of update rects
+ * @param _capacity is the needed size, updated with the real size of the array
+ * @return the array
+ */
+SDL_Rect * Region::acquireRects(int & _capacity)
+{
+    SDL_Rect *  ret     = 0;
+    int         index   = 0;
+
+    // THE OFFSCREEN SURFACES MAY BE RENDERED IN PARALLEL
+    ThreadPool::Guard guard;
+
+    while (index<nbRectsPools-1 && (nbRectsMin<<index)<_capacity) { index++; }
+    _capacity = nbRectsMin<<index;
+
+    if (rectsPool[index].empty())   { ret = new SDL_Rect[_capacity]; }
+    else                            { ret = rectsPool[index].back(); rectsPool[index].pop_back(); }
+
+    return ret;
+}
+
+/**
+ * Give an array back to the pool of update rects
+ * @param _rects is the array
+ * @param _capacity is the size of the array
+ */
+void Region::releaseRects(SDL_Rect * _rects, int _capacity)
+{
+    if (_rects)
+    {
+        ThreadPool::Guard guard;
+
+        int index = 0;
+        while (index<nbRectsPools-1 && (nbRectsMin<<index)<_capacity) { index++; }
+        rectsPool[index].push_back(_rects);
+    }
+}
+
+/**
+ * Set the region size (the region is cleared if the size changes)
+ * @param _width is the region width
+ * @param _height is the region height
+ * @return true if the size has changed
+ */
+bool Region::resize(int _width, int _height)
+{
+    bool ret;
+
+    if (_width<0)   { _width = 0; }
+    if (_height<0)  { _height = 0; }
+
+    if ((ret = (_width!=width || _height!=height)))
+    {
+        width       = _width;
+        height      = _height;
+        nbColumns   = (width+tileSize-1)/tileSize;
+        nbRows      = (height+tileSize-1)/tileSize;
+
+        tiles.assign(nbColumns*nbRows, Tile());
+        tileRects.assign(nbColumns*nbRows, -1);
+        banded          = false;
+        dirtyTiles.clear();
+        numberOfPixels  = 0;
+        changed         = true;
+    }
+
+    return ret;
+}
+
+/**
+ * Add a damaged rect
+ * @param _rect is the rect (clipped to the region)
+ * @return the number of new damaged pixels
+ */
+int Region::add(const SDL_Rect * _rect)
+{
+    int ret = 0;
+
+    int x0 = _rect->x>0?_rect->x:0;
+    int y0 = _rect->y>0?_rect->y:0;
+    int x1 = _rect->x+_rect->w<width?_rect->x+_rect->w:width;
+    int y1 = _rect->y+_rect->h<height?_rect->y+_rect->h:height;
+
+    if (x0<x1 && y0<y1)
+    {
+        // ONLY THE TILES COVERED BY THE RECT ARE VISITED
+        for (int r=y0/tileSize; r<=(y1-1)/tileSize; r++)
+        {
+            int ty0 = r*tileSize>y0?r*tileSize:y0;
+            int ty1 = (r+1)*tileSize<y1?(r+1)*tileSize:y1;
+
+            for (int c=x0/tileSize; c<=(x1-1)/tileSize; c++)
+            {
+                int     tx0     = c*tileSize>x0?c*tileSize:x0;
+                int     tx1     = (c+1)*tileSize<x1?(c+1)*tileSize:x1;
+                Tile &  tile    = tiles[r*nbColumns+c];
+
+                if (tile.x1<=tile.x0)
+                {
+                    tile.x0 = tx0; tile.y0 = ty0; tile.x1 = tx1; tile.y1 = ty1;
+                    dirtyTiles.push_back(r*nbColumns+c);
+                    ret += (tx1-tx0)*(ty1-ty0);
+                }
+                else
+                {
+                    int pixels = (tile.x1-tile.x0)*(tile.y1-tile.y0);
+                    if (tx0<tile.x0) { tile.x0 = tx0; }
+                    if (ty0<tile.y0) { tile.y0 = ty0; }
+                    if (tx1>tile.x1) { tile.x1 = tx1; }
+                    if (ty1>tile.y1) { tile.y1 = ty1; }
+                    ret += (tile.x1-tile.x0)*(tile.y1-tile.y0) - pixels;
+                }
+            }
+        }
+
+        if (ret) { numberOfPixels += ret; changed = true; }
+    }
+
+    return ret;
+}
+
+/**
+ * Clear the region
+ */
+void Region::clear()
+{
+    for (std::vector<int>::const_iterator it=dirtyTiles.begin(); it!=dirtyTiles.end(); it++)
+    {
+        tiles[*it].x0 = tiles[*it].y0 = tiles[*it].x1 = tiles[*it].y1 = 0;
+        tileRects[*it] = -1;
+    }
+    dirtyTiles.clear();
+    if (banded) { tileRects.assign(tileRects.size(), -1); banded = false; }
+
+    // THE RECTS ARRAY GOES BACK TO THE POOL UNTIL THE NEXT DAMAGE
+    releaseRects(rects, capacity);
+    rects       = 0;
+    capacity    = 0;
+    nbRects     = 0;
+
+    if (numberOfPixels) { changed = true; }
+    numberOfPixels = 0;
+}
+
+/**
+ * Get the region as a list of rects: the tiles boxes are merged horizontally then vertically
+ * (or by tile rows if there are more than nbRectsMax rects)
+ * @param _nbRects is the number of rects (output)
+ * @return the rects array (valid until the next clear)
+ */
+SDL_Rect * Region::getRects(int & _nbRects)
+{
+    if (changed)
+    {
+        changed = false;
+        nbRects = 0;
+
+        if (numberOfPixels)
+        {
+            // THERE ARE NEVER MORE RECTS THAN DAMAGED TILES
+            int needed = dirtyTiles.size()<static_cast<unsigned int>(nbRectsMax)?dirtyTiles.size():nbRectsMax;
+            if (capacity<needed) { releaseRects(rects, capacity); capacity = needed; rects = acquireRects(capacity); }
+
+            // TOO MANY RECTS: DEGRADE TO A COARSER REGION INSTEAD OF LOSING DAMAGE
+            if (banded) { tileRects.assign(tileRects.size(), -1); banded = false; }
+            if ((nbRects = merge())<0) { nbRects = bands(); }
+        }
+    }
+
+    _nbRects = nbRects;
+    return rects;
+}
+
+/**
+ * Merge the tiles boxes into rects
+ * @return the number of rects, -1 if the array is too small
+ */
+int Region::merge()
+{
+    int ret         = 0;
+    int nbOpen      = 0;
+
+    openRects.clear();
+    for (int r=0; r<nbRows; r++)
+    {
+        int top     = r*tileSize;
+        int o       = 0;
+
+        nextRects.clear();
+        for (int c=0; c<nbColumns; c++)
+        {
+            const Tile * tile = &tiles[r*nbColumns+c];
+            if (tile->x1<=tile->x0) { continue; }
+
+            // MERGE THE TILES BOXES WHICH ARE TOUCHING HORIZONTALLY WITH THE SAME VERTICAL RANGE
+            int x0 = tile->x0, y0 = tile->y0, x1 = tile->x1, y1 = tile->y1, c0 = c;
+            while ( c+1<nbColumns && x1==(c+1)*tileSize )
+            {
+                const Tile * right = &tiles[r*nbColumns+c+1];
+                if (right->x1<=right->x0 || right->x0!=x1 || right->y0!=y0 || right->y1!=y1) { break; }
+                x1 = right->x1;
+                c++;
+            }
+
+            // MERGE WITH THE RECT ABOVE IF IT HAS THE SAME HORIZONTAL RANGE (BOTH LISTS ARE SORTED BY X)
+            int index;
+            while (o<nbOpen && rects[openRects[o]].x<x0) { o++; }
+            if (o<nbOpen && y0==top && rects[openRects[o]].x==x0 && rects[openRects[o]].x+rects[openRects[o]].w==x1 &&
+                rects[openRects[o]].y+rects[openRects[o]].h==top)
+            {
+                index = openRects[o];
+                rects[index].h += y1-y0;
+                nextRects.push_back(index);
+                o++;
+            }
+            else
+            if (ret<capacity)
+            {
+                index = ret;
+                rects[ret].x = x0; rects[ret].y = y0; rects[ret].w = x1-x0; rects[ret].h = y1-y0;
+                nextRects.push_back(ret);
+                ret++;
+            }
+            else
+            {
+                return -1;
+            }
+
+            for (int i=c0; i<=c; i++) { tileRects[r*nbColumns+i] = index; }
+        }
+
+        openRects.swap(nextRects);
+        nbOpen = openRects.size();
+    }
+
+    return ret;
+}
+
+/**
+ * Build one rect per tile row (coarser region), the rows with the same range are merged
+ * @return the number of rects
+ */
+int Region::bands()
+{
+    int ret = 0;
+
+    for (int r=0; r<nbRows && ret<capacity; r++)
+    {
+        int x0 = width, y0 = height, x1 = 0, y1 = 0;
+        for (int c=0; c<nbColumns; c++)
+        {
+            const Tile * tile = &tiles[r*nbColumns+c];
+            if (tile->x1<=tile->x0) { continue; }
+            if (tile->x0<x0) { x0 = tile->x0; }
+            if (tile->y0<y0) { y0 = tile->y0; }
+            if (tile->x1>x1) { x1 = tile->x1; }
+            if (tile->y1>y1) { y1 = tile->y1; }
+        }
+
+        if (x0<x1)
+        {
+            SDL_Rect * last = ret?&rects[ret-1]:0;
+            if (last && last->x==x0 && last->w==x1-x0 && last->y+last->h==y0)   { last->h += y1-y0; }
+            else { rects[ret].x = x0; rects[ret].y = y0; rects[ret].w = x1-x0; rects[ret].h = y1-y0; ret++; }
+
+            // THE BAND ALSO COVERS THE UNDAMAGED TILES BETWEEN ITS BOUNDS
+            for (int c=x0/tileSize; c<=(x1-1)/tileSize; c++) { tileRects[r*nbColumns+c] = ret-1; }
+            banded = true;
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * Find the rects intersecting an area: only the tiles covered by the area are visited
+ * (or the rects if there are less rects than tiles). The rects must be built first (getRects)
+ * @param _area is the area
+ * @param _indices is the list of the rects index (output, appended)
+ * @return the number of found rects
+ */
+int Region::findRects(const SDL_Rect * _area, std::vector<int> & _indices)
+{
+    int ret = 0;
+
+    int x0 = _area->x>0?_area->x:0;
+    int y0 = _area->y>0?_area->y:0;
+    int x1 = _area->x+_area->w<width?_area->x+_area->w:width;
+    int y1 = _area->y+_area->h<height?_area->y+_area->h:height;
+
+    if (nbRects && x0<x1 && y0<y1)
+    {
+        int c0 = x0/tileSize, c1 = (x1-1)/tileSize, r0 = y0/tileSize, r1 = (y1-1)/tileSize;
+
+        if ((c1-c0+1)*(r1-r0+1)>nbRects)
+        {
+            // FEWER RECTS THAN TILES: CHECK THEM ALL
+            for (int i=0; i<nbRects; i++)
+            {
+                if (rects[i].x<x1 && rects[i].y<y1 && rects[i].x+rects[i].w>x0 && rects[i].y+rects[i].h>y0)
+                {
+                    _indices.push_back(i);
+                    ret++;
+                }
+            }
+        }
+        else
+        {
+            // A RECT COVERS SEVERAL TILES: THE STAMPS AVOID THE DUPLICATES
+            if (static_cast<int>(stamps.size())<capacity) { stamps.resize(capacity, 0); }
+            if (++stamp<=0) { stamps.assign(stamps.size(), 0); stamp = 1; }
+
+            for (int r=r0; r<=r1; r++)
+            for (int c=c0; c<=c1; c++)
+            {
+                int i = tileRects[r*nbColumns+c];
+                if (i>=0 && stamps[i]!=stamp)
+                {
+                    stamps[i] = stamp;
+                    if (rects[i].x<x1 && rects[i].y<y1 && rects[i].x+rects[i].w>x0 && rects[i].y+rects[i].h>y0)
+                    {
+                        _indices.push_back(i);
+                        ret++;
+                    }
+                }
+            }
+        }
+    }
+
+    return ret;
+}
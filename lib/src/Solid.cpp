@@ -30,6 +30,7 @@ using namespace splashouilleImpl;
 Solid::Solid(const std::string & _id, libconfig::Setting & _setting) : splashouilleImpl::Object(_id)
 {
     type = TYPE_SOLID;
+    setKind(this);
 
     // Fashion and style import
     Object::import(_setting);
@@ -38,6 +39,7 @@ Solid::Solid(const std::string & _id, libconfig::Setting & _setting) : splashoui
 Solid::Solid(const std::string & _id, Solid * _solid) : splashouilleImpl::Object(_id)
 {
     type = TYPE_SOLID;
+    setKind(this);
 
     // Copy the fashion
     cloneFashion(_solid);
@@ -46,6 +48,7 @@ Solid::Solid(const std::string & _id, Solid * _solid) : splashouilleImpl::Object
 Solid::Solid(const std::string & _id) : splashouilleImpl::Object(_id)
 {
     type = TYPE_SOLID;
+    setKind(this);
 }
 
 Solid::~Solid()
@@ -71,11 +74,24 @@ bool Solid::outCrowd()
  */
 bool Solid::render(SDL_Surface * _surface, SDL_Rect * _offset)
 {
-    const splashouille::Style * style = fashion->getCurrent();
+    DisplayList::Command command;
+    if (compile(_surface, _offset, &command)) { DisplayList::blit(_surface, command); }
+    return true;
+}
 
-    // Update the SDL_Rect position if necessary
-    //if (style->getDisplay() && updateArea->w && updateArea->h)
-    if (style->getDisplay())
+/**
+ * Prepare the render of the object and get its blit command
+ * @param _surface is the surface to fill
+ * @param _offset is the parent offset
+ * @param _command is the blit command (output)
+ * @return true if there is something to blit
+ */
+bool Solid::compile(SDL_Surface * _surface UNUSED, SDL_Rect * _offset, DisplayList::Command * _command)
+{
+    bool            ret     = false;
+    const Style *   style   = fashion->getCurrent();
+
+    if (style->isDisplayed())
     {
         // Rebuild the surface if it is too small (create a greater surface than needed for avoiding creation)
         if (!surface || (surface->w<position->w || surface->h<position->h))
@@ -90,53 +106,43 @@ bool Solid::render(SDL_Surface * _surface, SDL_Rect * _offset)
             surface = SDL_DisplayFormat(tmp);
             SDL_FreeSurface(tmp);
 
-            style->getBackgroundColor(red, green, blue);
+            red = style->getColor()[0]; green = style->getColor()[1]; blue = style->getColor()[2];
             SDL_FillRect(surface, 0, SDL_MapRGB(surface->format, red, green, blue));
         }
 
         // Handle the color if necessary
-        int r,g,b; style->getBackgroundColor(r, g, b);
-        if ((red!=r)||(green!=g)||(blue!=b))
+        const int * rgb = style->getColor();
+        if ((red!=rgb[0])||(green!=rgb[1])||(blue!=rgb[2]))
         {
-            red = r; green = g; blue = b;
+            red = rgb[0]; green = rgb[1]; blue = rgb[2];
             SDL_FillRect(surface, 0, SDL_MapRGB(surface->format, red, green, blue));
         }
 
-        // Handle the solid opacity
-        SDL_SetAlpha(surface, SDL_SRCALPHA | SDL_RLEACCEL, style->getOpacity());
-
-        // Handle the parent offset if any
-        SDL_Rect vPosition;
-        SDL_Rect vSource;
-        splashouille::Engine::copy(&vPosition, position);
-        splashouille::Engine::copy(&vSource, source);
-        if (_offset) {
-            splashouille::Engine::offset(&vPosition, _offset);
-
-            if (vPosition.y<_offset->y)
-            {
-                if (vPosition.h>(_offset->y-vPosition.y)) { vPosition.h-=(_offset->y-vPosition.y); } else { vPosition.h = 0; }
-                vSource.y-=(vPosition.y-_offset->y);
-                vPosition.y = _offset->y;
-            }
-
-            if (vPosition.x<_offset->x)
-            {
-                if (vPosition.w>(_offset->x-vPosition.x)) { vPosition.w-=(_offset->x-vPosition.x); } else { vPosition.w = 0; }
-                vSource.x-=(vPosition.x-_offset->x);
-                vPosition.x = _offset->x;
-            }
-
-            vSource.w = vPosition.w;
-            vSource.h = vPosition.h;
-        }
+        // Handle the solid opacity and the parent offset if any
+        _command->surface   = surface;
+        _command->alpha     = style->getAlpha();
+        ret                 = DisplayList::place(position, source, _offset, _command);
+    }
 
-        // Draw the solid
-        if (vPosition.w>0 && vPosition.h>0) { SDL_BlitSurface(surface, &vSource, _surface, &vPosition); }
+    return ret;
+}
 
-    }
+/**
+ * Get the area fully covered by the solid when it is rendered (used for the occlusion)
+ * @param _rect is the opaque area in the parent coordinates (output)
+ * @return true if the solid is opaque on a not empty area
+ */
+bool Solid::getOpaqueRect(SDL_Rect * _rect)
+{
+    const Style * style = fashion->getCurrent();
 
-    return true;
+    // THE SURFACE IS ALWAYS GREATER THAN THE POSITION AND FILLED WITH THE COLOR
+    bool ret = style->getAlpha()>=255 && position->w && position->h &&
+               source->x==0 && source->y==0 && (!surface || !surface->format->Amask);
+
+    if (ret) { splashouille::Engine::copy(_rect, position); }
+
+    return ret;
 }
 
 /**
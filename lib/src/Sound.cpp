@@ -85,6 +85,7 @@ bool Sound::setFilename(const std::string & _filename, bool _isChunk)
 Sound::Sound(const std::string & _id, libconfig::Setting & _setting) : splashouilleImpl::Object(_id)
 {
     type = TYPE_SOUND;
+    setKind(this);
     sound = 0;
     isChunk = false;
 
@@ -109,6 +110,7 @@ Sound::Sound(const std::string & _id, libconfig::Setting & _setting) : splashoui
 Sound::Sound(const std::string & _id, Sound * _sound) : splashouilleImpl::Object(_id)
 {
     type = TYPE_SOUND;
+    setKind(this);
     sound = 0;
 
     setFilename(_sound->getFilename(), _sound->getChunk());
@@ -120,6 +122,7 @@ Sound::Sound(const std::string & _id, Sound * _sound) : splashouilleImpl::Object
 Sound::Sound(const std::string & _id) : splashouilleImpl::Object(_id)
 {
     type = TYPE_SOLID;
+    setKind(this);
     sound = 0;
 }
 
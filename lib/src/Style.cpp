@@ -17,12 +17,17 @@ SPLASHOUILLE.  If not, see http://www.gnu.org/licenses/
 
 #include <splashouille/Defines.hpp>
 #include <splashouilleImpl/Style.hpp>
+#include <splashouilleImpl/Object.hpp>
 
 #include <libconfig.h++>
 
 #include <iostream>
 #include <iomanip>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #ifdef __GNUC__
 #define UNUSED __attribute__((unused))
 #else
@@ -31,9 +36,12 @@ SPLASHOUILLE.  If not, see http://www.gnu.org/licenses/
 
 using namespace splashouilleImpl;
 
-Style::Style()                                  { reset(); }
-Style::Style(libconfig::Setting & _setting)     { reset(); import(_setting); }
-Style::Style(splashouille::Style * _style)      { copy(_style); }
+const int Style::laneBits[nbLanes] = { 1<<__left, 1<<__top, 1<<__width, 1<<__height, 1<<__positionX, 1<<__positionY,
+                                       1<<__relativeleft, 1<<__relativetop };
+
+Style::Style() : owner(0)                               { reset(); }
+Style::Style(libconfig::Setting & _setting) : owner(0)  { reset(); import(_setting); }
+Style::Style(splashouille::Style * _style) : owner(0)   { copy(_style); }
 Style::~Style() { }
 
 /**
@@ -44,12 +52,12 @@ void Style::import(libconfig::Setting & _setting)
 {
     int value;
 
-    if (_setting.lookupValue(STYLE_LEFT, value))                        { left = value; bitmap|=(1<<__left); }
-    if (_setting.lookupValue(STYLE_TOP, value))                         { top = value;  bitmap|=(1<<__top); }
-    if (_setting.lookupValue(STYLE_RELATIVE_LEFT, value))               { relativeLeft = value; bitmap|=(1<<__relativeleft); }
-    if (_setting.lookupValue(STYLE_RELATIVE_TOP, value))                { relativeTop = value;  bitmap|=(1<<__relativetop); }
-    if (_setting.lookupValue(STYLE_WIDTH, value))                       { width= value; bitmap|=(1<<__width); }
-    if (_setting.lookupValue(STYLE_HEIGHT, value))                      { height=value; bitmap|=(1<<__height); }
+    if (_setting.lookupValue(STYLE_LEFT, value))                        { values[laneLeft] = value; bitmap|=(1<<__left); }
+    if (_setting.lookupValue(STYLE_TOP, value))                         { values[laneTop] = value;  bitmap|=(1<<__top); }
+    if (_setting.lookupValue(STYLE_RELATIVE_LEFT, value))               { values[laneRelativeLeft] = value; bitmap|=(1<<__relativeleft); }
+    if (_setting.lookupValue(STYLE_RELATIVE_TOP, value))                { values[laneRelativeTop] = value;  bitmap|=(1<<__relativetop); }
+    if (_setting.lookupValue(STYLE_WIDTH, value))                       { values[laneWidth]= value; bitmap|=(1<<__width); }
+    if (_setting.lookupValue(STYLE_HEIGHT, value))                      { values[laneHeight]=value; bitmap|=(1<<__height); }
     if (_setting.lookupValue(STYLE_OPACITY, opacity))                   { bitmap|=(1<<__opacity); }
     if (_setting.lookupValue(STYLE_USER, user))                         { bitmap|=(1<<__user); }
     if (_setting.lookupValue(STYLE_DISPLAY, value))                     { display=(value); bitmap|=(1<<__display); }
@@ -62,15 +70,16 @@ void Style::import(libconfig::Setting & _setting)
 
     if (_setting.exists(STYLE_POSITION))
     {
-        for (int i=0; i<2; i++) position[i] = (int)_setting[STYLE_POSITION][i];
+        for (int i=0; i<2; i++) values[lanePositionX+i] = (int)_setting[STYLE_POSITION][i];
         bitmap|=(1<<__positionX) | (1<<__positionY);
     }
     else
     {
-        if (_setting.lookupValue(STYLE_POSITION_X, value))                { position[0] = value; bitmap|=(1<<__positionX); }
-        if (_setting.lookupValue(STYLE_POSITION_Y, value))                { position[1] = value; bitmap|=(1<<__positionY); }
+        if (_setting.lookupValue(STYLE_POSITION_X, value))                { values[lanePositionX] = value; bitmap|=(1<<__positionX); }
+        if (_setting.lookupValue(STYLE_POSITION_Y, value))                { values[lanePositionY] = value; bitmap|=(1<<__positionY); }
     }
 
+    if (owner) { wakeOwner(); }
 }
 
 /**
@@ -79,13 +88,13 @@ void Style::import(libconfig::Setting & _setting)
 void Style::reset()
 {
     bitmap                      = 0;
-    top = left = width = height = 0;
-    relativeLeft = relativeTop  = 0;
+    values[laneTop] = values[laneLeft] = values[laneWidth] = values[laneHeight] = 0;
+    values[laneRelativeLeft] = values[laneRelativeTop]  = 0;
     display                     = true;
     opacity                     = 255;
     user                        = 0;
     backgroundColor[0] = backgroundColor[1] = backgroundColor[2] = 0;
-    position[0] = position[1]   = 0;
+    values[lanePositionX] = values[lanePositionY]   = 0;
     touch();
 }
 
@@ -95,6 +104,15 @@ void Style::reset()
 void Style::touch()
 {
     changed                     = (1<<__last)-1;
+    if (owner) { wakeOwner(); }
+}
+
+/**
+ * Wake the owner object up (a sleeping object does not see the changes of its style otherwise)
+ */
+void Style::wakeOwner()
+{
+    owner->wake();
 }
 
 /**
@@ -103,25 +121,22 @@ void Style::touch()
  */
 void Style::copy(const splashouille::Style * _style)
 {
+    // ALL THE STYLES ARE CONCRETE STYLES: THE PROPERTIES ARE READ WITHOUT VIRTUAL CALLS
+    const Style * s = static_cast<const Style*>(_style);
+
     if (_style!=this)
     {
         reset();
 
-        left                = _style->getLeft();
-        top                 = _style->getTop();
-        relativeLeft        = _style->getRelativeLeft();
-        relativeTop         = _style->getRelativeTop();
-        width               = _style->getWidth();
-        height              = _style->getHeight();
-        display             = _style->getDisplay();
-        opacity             = _style->getOpacity();
-        user                = _style->getUser();
-
-        _style->getBackgroundColor(backgroundColor[0], backgroundColor[1], backgroundColor[2]);
-        _style->getPosition(position[0], position[1]);
-
-        bitmap  = _style->getBitmap();
-        changed = _style->getBitmap();
+        for (int i=0; i<nbLanes; i++) { values[i] = s->values[i]; }
+        display             = s->display;
+        opacity             = s->opacity;
+        user                = s->user;
+
+        for (int i=0; i<3; i++) { backgroundColor[i] = s->backgroundColor[i]; }
+
+        bitmap  = s->bitmap;
+        changed = s->bitmap;
     }
 }
 
@@ -131,30 +146,40 @@ void Style::copy(const splashouille::Style * _style)
  */
 void Style::add(const splashouille::Style * _style)
 {
+    add(_style, static_cast<const Style*>(_style)->bitmap);
+}
+
+/**
+ * Set some style properties by addying another style
+ * @param _style is the style to add
+ * @param _properties is the bitmap of the properties to add
+ */
+void Style::add(const splashouille::Style * _style, long _properties)
+{
+    const Style *   s       = static_cast<const Style*>(_style);
+    long            used    = s->bitmap&_properties;
+
     if (_style!=this)
     {
-        if (_style->getBitmap()&(1<<__left))        { setLeft           ( _style->getLeft()); }
-        if (_style->getBitmap()&(1<<__top))         { setTop            ( _style->getTop()); }
-        if (_style->getBitmap()&(1<<__relativeleft)){ setRelativeLeft   ( _style->getRelativeLeft()); }
-        if (_style->getBitmap()&(1<<__relativetop)) { setRelativeTop    ( _style->getRelativeTop()); }
-        if (_style->getBitmap()&(1<<__width))       { setWidth          ( _style->getWidth()); }
-        if (_style->getBitmap()&(1<<__height))      { setHeight         ( _style->getHeight()); }
-        if (_style->getBitmap()&(1<<__display))     { setDisplay        ( _style->getDisplay()); }
-        if (_style->getBitmap()&(1<<__opacity))     { setOpacity        ( _style->getOpacity()); }
-        if (_style->getBitmap()&(1<<__user))        { setUser           ( _style->getUser()); }
-
-        if (_style->getBitmap()&(1<<__backgroundColor))
+        if (used&(1<<__left))        { setLeft           ( s->values[laneLeft]); }
+        if (used&(1<<__top))         { setTop            ( s->values[laneTop]); }
+        if (used&(1<<__relativeleft)){ setRelativeLeft   ( s->values[laneRelativeLeft]); }
+        if (used&(1<<__relativetop)) { setRelativeTop    ( s->values[laneRelativeTop]); }
+        if (used&(1<<__width))       { setWidth          ( s->values[laneWidth]); }
+        if (used&(1<<__height))      { setHeight         ( s->values[laneHeight]); }
+        if (used&(1<<__display))     { setDisplay        ( s->display); }
+        if (used&(1<<__opacity))     { setOpacity        ( s->opacity); }
+        if (used&(1<<__user))        { setUser           ( s->user); }
+
+        if (used&(1<<__backgroundColor))
         {
-            int red, green, blue;
-            _style->getBackgroundColor(red, green, blue);
-            setBackgroundColor(red, green, blue);
+            setBackgroundColor(s->backgroundColor[0], s->backgroundColor[1], s->backgroundColor[2]);
         }
 
-        float p[2]; _style->getPosition(p[0], p[1]);
-        if (_style->getBitmap()&(1<<__positionX))   {   setPositionX    (p[0]); }
-        if (_style->getBitmap()&(1<<__positionY))   {   setPositionY    (p[1]); }
+        if (used&(1<<__positionX))   {   setPositionX    (s->values[lanePositionX]); }
+        if (used&(1<<__positionY))   {   setPositionY    (s->values[lanePositionY]); }
 
-        bitmap  |= _style->getBitmap();
+        bitmap  |= used;
     }
 }
 
@@ -165,32 +190,202 @@ void Style::add(const splashouille::Style * _style)
  */
 void Style::mix(const splashouille::Style * _style, float _ratio)
 {
+    const Style * s = static_cast<const Style*>(_style);
+
     if (_style!=this)
     {
-        int both = bitmap&_style->getBitmap();
-        if ( both&(1<<__left) )         setLeft         ( mix(left, _style->getLeft(), _ratio) );
-        if ( both&(1<<__top) )          setTop          ( mix(top, _style->getTop(), _ratio) );
-        if ( both&(1<<__relativeleft) ) setRelativeLeft ( mix(relativeLeft, _style->getRelativeLeft(), _ratio) );
-        if ( both&(1<<__relativetop) )  setRelativeTop  ( mix(relativeTop, _style->getRelativeTop(), _ratio) );
-        if ( both&(1<<__width) )        setWidth        ( mix(width, _style->getWidth(), _ratio) );
-        if ( both&(1<<__height) )       setHeight       ( mix(height, _style->getHeight(),_ratio) );
-        if ( both&(1<<__opacity) )      setOpacity      ( mix(opacity, _style->getOpacity(), _ratio) );
-        if ( both&(1<<__user) )         setUser         ( mix(user, _style->getUser(), _ratio) );
-
-        if ( both&(1<<__backgroundColor) )
+        int     both = bitmap&s->bitmap;
+
+#ifdef __SSE2__
+        // THE FLOAT PROPERTIES ARE BLENDED 4 LANES AT A TIME: ONLY THE COMMON ONES ARE SET, THE ONES
+        // WHOSE PIXEL VALUE MOVES ARE CHANGED (SAME RESULT AS mix AND d ON EACH PROPERTY)
+        const __m128    ratio   = _mm_set1_ps(_ratio);
+        const __m128    rest    = _mm_set1_ps(1-_ratio);
+        const __m128i   common  = _mm_set1_epi32(both);
+        int             lanes   = 0;
+        for (int i=0; i<nbLanes; i+=4)
+        {
+            __m128i bits    = _mm_loadu_si128(reinterpret_cast<const __m128i*>(laneBits+i));
+            __m128  value   = _mm_loadu_ps(values+i);
+            __m128  blend   = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(s->values+i), ratio), _mm_mul_ps(value, rest));
+            __m128i used    = _mm_cmpeq_epi32(_mm_and_si128(common, bits), bits);
+            __m128i moved   = _mm_andnot_si128(_mm_cmpeq_epi32(_mm_cvttps_epi32(value), _mm_cvttps_epi32(blend)), used);
+
+            _mm_storeu_ps(values+i, _mm_or_ps(_mm_and_ps(_mm_castsi128_ps(used), blend),
+                                              _mm_andnot_ps(_mm_castsi128_ps(used), value)));
+
+            // THE CHANGE BITS OF THE MOVED LANES ARE MERGED ACROSS THE REGISTER
+            moved = _mm_and_si128(moved, bits);
+            moved = _mm_or_si128(moved, _mm_shuffle_epi32(moved, 0x4e));
+            moved = _mm_or_si128(moved, _mm_shuffle_epi32(moved, 0xb1));
+            lanes |= _mm_cvtsi128_si32(moved);
+        }
+        changed |= lanes;
+        if (owner && lanes) { wakeOwner(); }
+#else
+        if ( both&(1<<__left) )         setLeft         ( mix(values[laneLeft], s->values[laneLeft], _ratio) );
+        if ( both&(1<<__top) )          setTop          ( mix(values[laneTop], s->values[laneTop], _ratio) );
+        if ( both&(1<<__relativeleft) ) setRelativeLeft ( mix(values[laneRelativeLeft], s->values[laneRelativeLeft], _ratio) );
+        if ( both&(1<<__relativetop) )  setRelativeTop  ( mix(values[laneRelativeTop], s->values[laneRelativeTop], _ratio) );
+        if ( both&(1<<__width) )        setWidth        ( mix(values[laneWidth], s->values[laneWidth], _ratio) );
+        if ( both&(1<<__height) )       setHeight       ( mix(values[laneHeight], s->values[laneHeight],_ratio) );
+        if ( both&(1<<__positionX) )    setPositionX    ( mix(values[lanePositionX], s->values[lanePositionX], _ratio) );
+        if ( both&(1<<__positionY) )    setPositionY    ( mix(values[lanePositionY], s->values[lanePositionY], _ratio) );
+#endif
+
+        mixOthers(s, both, _ratio);
+    }
+}
+
+/**
+ * Mix a batch of styles: same result as _styles[i]->mix(_targets[i], _ratios[i]) for each i
+ * (a style is mixed only once in a batch and is not the target of another mix)
+ * @param _styles are the styles to set
+ * @param _targets are the styles to mix
+ * @param _ratios are the ratios of the new styles
+ * @param _size is the number of mixes
+ * @param _lanes are the buffers of the batch
+ */
+void Style::mix(Style * const * _styles, const Style * const * _targets, const float * _ratios, int _size, Lanes & _lanes UNUSED)
+{
+#ifdef __SSE2__
+    if (_size<=0) { return; }
+
+    // THE BUFFERS ARE PADDED UP TO 4 STYLES (THE PADDING HAS NO COMMON PROPERTY), THEY ONLY GROW
+    int padded = (_size+3)&~3;
+    if (static_cast<int>(_lanes.ratios.size())<padded)
+    {
+        for (int l=0; l<nbLanes; l++) { _lanes.values[l].resize(padded); _lanes.targets[l].resize(padded); }
+        _lanes.ratios.resize(padded);
+        _lanes.common.resize(padded);
+        _lanes.moved.resize(padded);
+    }
+
+    float *         values[nbLanes];
+    float *         targets[nbLanes];
+    float *         ratios  = &_lanes.ratios[0];
+    int *           common  = &_lanes.common[0];
+    int *           moved   = &_lanes.moved[0];
+    for (int l=0; l<nbLanes; l++) { values[l] = &_lanes.values[l][0]; targets[l] = &_lanes.targets[l][0]; }
+
+    // GATHER THE LANES ACROSS THE STYLES: THE LANES OF 4 STYLES ARE TRANSPOSED IN REGISTERS
+    for (int i=0; i<padded; i+=4)
+    {
+        if (i+4<=_size)
+        {
+            for (int h=0; h<nbLanes; h+=4)
+            {
+                __m128 v0 = _mm_loadu_ps(_styles[i]->values+h),   v1 = _mm_loadu_ps(_styles[i+1]->values+h);
+                __m128 v2 = _mm_loadu_ps(_styles[i+2]->values+h), v3 = _mm_loadu_ps(_styles[i+3]->values+h);
+                __m128 t0 = _mm_loadu_ps(_targets[i]->values+h),  t1 = _mm_loadu_ps(_targets[i+1]->values+h);
+                __m128 t2 = _mm_loadu_ps(_targets[i+2]->values+h),t3 = _mm_loadu_ps(_targets[i+3]->values+h);
+                _MM_TRANSPOSE4_PS(v0, v1, v2, v3);
+                _MM_TRANSPOSE4_PS(t0, t1, t2, t3);
+                _mm_storeu_ps(values[h]+i, v0);   _mm_storeu_ps(values[h+1]+i, v1);
+                _mm_storeu_ps(values[h+2]+i, v2); _mm_storeu_ps(values[h+3]+i, v3);
+                _mm_storeu_ps(targets[h]+i, t0);  _mm_storeu_ps(targets[h+1]+i, t1);
+                _mm_storeu_ps(targets[h+2]+i, t2);_mm_storeu_ps(targets[h+3]+i, t3);
+            }
+        }
+        else
         {
-            int rgb[3];
-            _style->getBackgroundColor(rgb[0],rgb[1],rgb[2]);
-            for (int i=0; i<3; i++) { rgb[i] = mix(backgroundColor[i], rgb[i], _ratio); }
-            setBackgroundColor(rgb[0], rgb[1], rgb[2]);
+            for (int j=i; j<i+4; j++)
+            {
+                for (int l=0; l<nbLanes; l++)
+                {
+                    values[l][j]    = (j<_size)?_styles[j]->values[l]:0;
+                    targets[l][j]   = (j<_size)?_targets[j]->values[l]:0;
+                }
+            }
         }
 
-        float p[2]; _style->getPosition(p[0], p[1]);
-        if ( both&(1<<__positionX) )    setPositionX    ( mix(position[0], p[0], _ratio) );
-        if ( both&(1<<__positionY) )    setPositionY    ( mix(position[1], p[1], _ratio) );
+        for (int j=i; j<i+4; j++)
+        {
+            common[j]   = (j<_size && _styles[j]!=_targets[j])?(_styles[j]->bitmap&_targets[j]->bitmap):0;
+            ratios[j]   = (j<_size)?_ratios[j]:0;
+        }
+    }
 
-        bitmap  |= _style->getBitmap();
+    // EACH LANE IS BLENDED FOR 4 STYLES AT A TIME (SAME OPERATIONS AS THE MIX OF ONE STYLE)
+    const __m128 one = _mm_set1_ps(1);
+    for (int i=0; i<padded; i+=4)
+    {
+        __m128  ratio   = _mm_loadu_ps(ratios+i);
+        __m128  rest    = _mm_sub_ps(one, ratio);
+        __m128i both    = _mm_loadu_si128(reinterpret_cast<const __m128i*>(common+i));
+        __m128i dirty   = _mm_setzero_si128();
+        for (int l=0; l<nbLanes; l++)
+        {
+            __m128i bits    = _mm_set1_epi32(laneBits[l]);
+            __m128  value   = _mm_loadu_ps(values[l]+i);
+            __m128  blend   = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(targets[l]+i), ratio), _mm_mul_ps(value, rest));
+            __m128i used    = _mm_cmpeq_epi32(_mm_and_si128(both, bits), bits);
+            __m128i lane    = _mm_andnot_si128(_mm_cmpeq_epi32(_mm_cvttps_epi32(value), _mm_cvttps_epi32(blend)), used);
+
+            _mm_storeu_ps(values[l]+i, _mm_or_ps(_mm_and_ps(_mm_castsi128_ps(used), blend),
+                                                 _mm_andnot_ps(_mm_castsi128_ps(used), value)));
+            dirty = _mm_or_si128(dirty, _mm_and_si128(lane, bits));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(moved+i), dirty);
     }
+
+    // SCATTER THE LANES BACK (TRANSPOSED AGAIN), THEN THE CHANGES AND THE OTHER PROPERTIES
+    int full = _size&~3;
+    for (int i=0; i<_size; i++)
+    {
+        if (i<full)
+        {
+            if (!(i&3))
+            {
+                for (int h=0; h<nbLanes; h+=4)
+                {
+                    __m128 v0 = _mm_loadu_ps(values[h]+i),   v1 = _mm_loadu_ps(values[h+1]+i);
+                    __m128 v2 = _mm_loadu_ps(values[h+2]+i), v3 = _mm_loadu_ps(values[h+3]+i);
+                    _MM_TRANSPOSE4_PS(v0, v1, v2, v3);
+                    _mm_storeu_ps(_styles[i]->values+h, v0);   _mm_storeu_ps(_styles[i+1]->values+h, v1);
+                    _mm_storeu_ps(_styles[i+2]->values+h, v2); _mm_storeu_ps(_styles[i+3]->values+h, v3);
+                }
+            }
+        }
+        else
+        {
+            for (int l=0; l<nbLanes; l++) { _styles[i]->values[l] = values[l][i]; }
+        }
+
+        // A STYLE MIXED WITH ITSELF HAS NO COMMON PROPERTY: ITS LANES ARE WRITTEN BACK UNCHANGED
+        Style * style = _styles[i];
+        if (style!=_targets[i])
+        {
+            style->changed |= moved[i];
+            if (style->owner && moved[i]) { style->wakeOwner(); }
+            style->mixOthers(_targets[i], common[i], _ratios[i]);
+        }
+    }
+#else
+    for (int i=0; i<_size; i++) { _styles[i]->mix(_targets[i], _ratios[i]); }
+#endif
+}
+
+/**
+ * Mix the properties which are not stored in the lanes, then add the new properties
+ * @param _style is the style to mix
+ * @param _both is the bitmap of the common properties
+ * @param _ratio is the ratio of the new style
+ */
+void Style::mixOthers(const Style * _style, int _both, float _ratio)
+{
+    if ( _both&(1<<__opacity) )     setOpacity      ( mix(opacity, _style->opacity, _ratio) );
+    if ( _both&(1<<__user) )        setUser         ( mix(user, _style->user, _ratio) );
+
+    if ( _both&(1<<__backgroundColor) )
+    {
+        int rgb[3];
+        for (int i=0; i<3; i++) { rgb[i] = mix(backgroundColor[i], _style->backgroundColor[i], _ratio); }
+        setBackgroundColor(rgb[0], rgb[1], rgb[2]);
+    }
+
+    if (owner && (_style->bitmap&~bitmap)) { wakeOwner(); }
+    bitmap  |= _style->bitmap;
 }
 
 /**
@@ -200,18 +395,19 @@ void Style::mix(const splashouille::Style * _style, float _ratio)
  */
 int Style::compare(const splashouille::Style * _style) const
 {
-    int ret = 0;
-    int both = bitmap&_style->getBitmap();
-
-    if ( both&(1<<__left) )         ret |= (d(left, _style->getLeft())<<__left);
-    if ( both&(1<<__top) )          ret |= (d(top, _style->getTop())<<__top);
-    if ( both&(1<<__relativeleft) ) ret |= (d(relativeLeft, _style->getRelativeLeft())<<__relativeleft);
-    if ( both&(1<<__relativetop) )  ret |= (d(relativeTop, _style->getRelativeTop())<<__relativetop);
-    if ( both&(1<<__width) )        ret |= (d(width, _style->getWidth())<<__width);
-    if ( both&(1<<__height) )       ret |= (d(height, _style->getHeight())<<__height);
-    if ( both&(1<<__opacity) )      ret |= (d(opacity, _style->getOpacity())<<__opacity);
-    if ( both&(1<<__user) )         ret |= (d(user, _style->getUser())<<__user);
-    if ( both&(1<<__display) )      ret |= (d(display, _style->getDisplay())<<__display);
+    const Style *   s       = static_cast<const Style*>(_style);
+    int             ret     = 0;
+    int             both    = bitmap&s->bitmap;
+
+    if ( both&(1<<__left) )         ret |= (d(values[laneLeft], s->values[laneLeft])<<__left);
+    if ( both&(1<<__top) )          ret |= (d(values[laneTop], s->values[laneTop])<<__top);
+    if ( both&(1<<__relativeleft) ) ret |= (d(values[laneRelativeLeft], s->values[laneRelativeLeft])<<__relativeleft);
+    if ( both&(1<<__relativetop) )  ret |= (d(values[laneRelativeTop], s->values[laneRelativeTop])<<__relativetop);
+    if ( both&(1<<__width) )        ret |= (d(values[laneWidth], s->values[laneWidth])<<__width);
+    if ( both&(1<<__height) )       ret |= (d(values[laneHeight], s->values[laneHeight])<<__height);
+    if ( both&(1<<__opacity) )      ret |= (d(opacity, s->opacity)<<__opacity);
+    if ( both&(1<<__user) )         ret |= (d(user, s->user)<<__user);
+    if ( both&(1<<__display) )      ret |= (d(display, s->display)<<__display);
 
     return ret;
 }
@@ -225,12 +421,12 @@ void Style::log(int _rank) const
 {
     std::string offset; offset.append(4*_rank,' ');
     std::cout<<offset<<"+ Style "<<" (bitmap: "<<bitmap<<")"<<std::endl;
-    if (bitmap&(1<<__left))         { std::cout<<offset<<".left     : "<<left<<std::endl; }
-    if (bitmap&(1<<__top))          { std::cout<<offset<<".top      : "<<top<<std::endl; }
-    if (bitmap&(1<<__relativeleft)) { std::cout<<offset<<".relleft  : "<<relativeLeft<<std::endl; }
-    if (bitmap&(1<<__relativetop))  { std::cout<<offset<<".reltop   : "<<relativeTop<<std::endl; }
-    if (bitmap&(1<<__width))        { std::cout<<offset<<".width    : "<<width<<std::endl; }
-    if (bitmap&(1<<__height))       { std::cout<<offset<<".heigh    : "<<height<<std::endl; }
+    if (bitmap&(1<<__left))         { std::cout<<offset<<".left     : "<<values[laneLeft]<<std::endl; }
+    if (bitmap&(1<<__top))          { std::cout<<offset<<".top      : "<<values[laneTop]<<std::endl; }
+    if (bitmap&(1<<__relativeleft)) { std::cout<<offset<<".relleft  : "<<values[laneRelativeLeft]<<std::endl; }
+    if (bitmap&(1<<__relativetop))  { std::cout<<offset<<".reltop   : "<<values[laneRelativeTop]<<std::endl; }
+    if (bitmap&(1<<__width))        { std::cout<<offset<<".width    : "<<values[laneWidth]<<std::endl; }
+    if (bitmap&(1<<__height))       { std::cout<<offset<<".heigh    : "<<values[laneHeight]<<std::endl; }
     if (bitmap&(1<<__display))      { std::cout<<offset<<".display  : "<<display<<std::endl; }
     if (bitmap&(1<<__opacity))      { std::cout<<offset<<".opacity  : "<<opacity<<std::endl; }
     if (bitmap&(1<<__user))         { std::cout<<offset<<".user     : "<<user<<std::endl; }
@@ -240,7 +436,7 @@ void Style::log(int _rank) const
     }
     if ((bitmap&(1<<__positionX)) || (bitmap&(1<<__positionY)))
     {
-        std::cout<<offset<<".position : ("<<position[0]<<","<<position[1]<<")"<<std::endl;
+        std::cout<<offset<<".position : ("<<values[lanePositionX]<<","<<values[lanePositionY]<<")"<<std::endl;
     }
 }
 
@@ -248,5 +444,5 @@ void Style::getBackgroundColor(int & _red, int & _green, int & _blue) const
 { _red = backgroundColor[0]; _green = backgroundColor[1]; _blue = backgroundColor[2]; }
 
 void Style::getPosition(float & _x, float & _y) const
-{ _x = position[0]; _y = position[1]; }
+{ _x = values[lanePositionX]; _y = values[lanePositionY]; }
 
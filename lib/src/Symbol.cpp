@@ -0,0 +1,113 @@
+/*
+Copyright 2011 JohannC
+
+This file is part of SPLASHOUILLE.
+
+SPLASHOUILLE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+SPLASHOUILLE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+SPLASHOUILLE.  If not, see http://www.gnu.org/licenses/
+*/
+
+#include <splashouilleImpl/Symbol.hpp>
+#include <deque>
+
+#include <SDL.h>
+#include <SDL_thread.h>
+
+using namespace splashouilleImpl;
+
+/**
+ * The table is built on first use, so the symbols can be used by the static initializers
+ * (it is locked since the threaded import interns its ids while the main thread is running)
+ */
+class SymbolTable
+{
+public:
+    std::tr1::unordered_map<std::string, int>   symbols;                // The symbol of each string
+    std::deque<std::string>                     names;                  // The string of each symbol (never moved)
+    SDL_mutex *                                 mutex;                  // The lock of the table
+
+    SymbolTable() : mutex(SDL_CreateMutex())
+                    { symbols.insert(std::pair<std::string, int>("", Symbol::empty)); names.push_back(""); }
+    ~SymbolTable()  { SDL_DestroyMutex(mutex); }
+};
+
+static SymbolTable & getTable()
+{
+    static SymbolTable table;
+    return table;
+}
+
+/**
+ * Get the symbol of a string (the string is interned if it is unknown)
+ * @param _name is the string
+ * @return the symbol
+ */
+int Symbol::get(const std::string & _name)
+{
+    SymbolTable & table = getTable();
+    std::pair<std::tr1::unordered_map<std::string, int>::iterator, bool> ret;
+
+    SDL_mutexP(table.mutex);
+    ret = table.symbols.insert(std::pair<std::string, int>(_name, table.names.size()));
+    if (ret.second) { table.names.push_back(_name); }
+    int symbol = ret.first->second;
+    SDL_mutexV(table.mutex);
+
+    return symbol;
+}
+
+/**
+ * Find the symbol of a string without interning it
+ * @param _name is the string
+ * @return the symbol (none if the string is unknown)
+ */
+int Symbol::find(const std::string & _name)
+{
+    SymbolTable & table = getTable();
+
+    SDL_mutexP(table.mutex);
+    std::tr1::unordered_map<std::string, int>::const_iterator it = table.symbols.find(_name);
+    int symbol = (it!=table.symbols.end())?it->second:none;
+    SDL_mutexV(table.mutex);
+
+    return symbol;
+}
+
+/**
+ * Get the string of a symbol
+ * @param _symbol is the symbol
+ * @return the string (valid until the end of the program)
+ */
+const std::string & Symbol::getName(int _symbol)
+{
+    SymbolTable & table = getTable();
+
+    SDL_mutexP(table.mutex);
+    const std::string & name = (_symbol>=0 && _symbol<static_cast<int>(table.names.size()))?table.names[_symbol]:table.names[empty];
+    SDL_mutexV(table.mutex);
+
+    return name;
+}
+
+/**
+ * Get the number of interned strings
+ * @return the size of the table
+ */
+int Symbol::getSize()
+{
+    SymbolTable & table = getTable();
+
+    SDL_mutexP(table.mutex);
+    int size = table.names.size();
+    SDL_mutexV(table.mutex);
+
+    return size;
+}
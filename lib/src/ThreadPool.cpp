@@ -0,0 +1,219 @@
+/*
+Copyright 2011 JohannC
+
+This file is part of SPLASHOUILLE.
+
+SPLASHOUILLE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+SPLASHOUILLE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+SPLASHOUILLE.  If not, see http://www.gnu.org/licenses/
+*/
+
+
+#include <splashouille/Defines.hpp>
+#include <splashouilleImpl/ThreadPool.hpp>
+#include <unistd.h>
+
+#include <SDL.h>
+#include <SDL_thread.h>
+
+using namespace splashouilleImpl;
+
+/** The pool state is built on first use */
+class Pool
+{
+public:
+    SDL_Thread *                                threads[ThreadPool::nbThreadsMax];  // The worker threads
+    int                                         nbThreads;              // The number of running workers
+    SDL_mutex *                                 mutex;                  // The lock of the stage state
+    SDL_mutex *                                 shared;                 // The lock of the states shared by the tasks
+    SDL_cond *                                  started;                // Signaled when a stage starts
+    SDL_cond *                                  finished;               // Signaled when the last chunk is done
+    ThreadPool::Task *                          task;                   // The running stage (0 if none)
+    int                                         size;                   // The number of indices of the stage
+    int                                         grain;                  // The number of indices of a chunk
+    int                                         next;                   // The first index of the next chunk
+    int                                         done;                   // The number of processed indices
+    unsigned int                                stage;                  // The stage counter
+    bool                                        quit;                   // Have the workers to stop
+
+    Pool():nbThreads(0), mutex(0), shared(0), started(0), finished(0), task(0), size(0), grain(1), next(0), done(0),
+           stage(0), quit(false) {}
+};
+
+static Pool & getPool()
+{
+    static Pool pool;
+    return pool;
+}
+
+/**
+ * Run the chunks of the current stage until there is none left (the mutex is locked)
+ * @param _pool is the pool
+ */
+static void runChunks(Pool & _pool)
+{
+    while (_pool.next<_pool.size)
+    {
+        ThreadPool::Task *  task    = _pool.task;
+        int                 begin   = _pool.next;
+        int                 end     = (begin+_pool.grain<_pool.size)?begin+_pool.grain:_pool.size;
+        _pool.next = end;
+
+        // THE STAGE CANNOT END BEFORE THIS CHUNK IS DONE: THE TASK IS STILL VALID WITHOUT THE LOCK
+        SDL_mutexV(_pool.mutex);
+        task->run(begin, end);
+        SDL_mutexP(_pool.mutex);
+
+        _pool.done += end-begin;
+        if (_pool.done>=_pool.size) { SDL_CondSignal(_pool.finished); }
+    }
+}
+
+/**
+ * The loop of a worker thread
+ * @param _data is not used
+ * @return 0
+ */
+static int work(void * _data UNUSED)
+{
+    Pool &          pool    = getPool();
+    unsigned int    stage   = 0;
+
+    SDL_mutexP(pool.mutex);
+    stage = pool.stage;
+    while (true)
+    {
+        while (!pool.quit && pool.stage==stage) { SDL_CondWait(pool.started, pool.mutex); }
+        if (pool.quit) { break; }
+
+        stage = pool.stage;
+        runChunks(pool);
+    }
+    SDL_mutexV(pool.mutex);
+
+    return 0;
+}
+
+/**
+ * Start the worker threads if they are not running
+ * @param _pool is the pool
+ * @return true if there are workers
+ */
+static bool start(Pool & _pool)
+{
+    if (!_pool.nbThreads && ThreadPool::getNbThreads()>1)
+    {
+        if (!_pool.mutex)
+        {
+            _pool.mutex     = SDL_CreateMutex();
+            _pool.shared    = SDL_CreateMutex();
+            _pool.started   = SDL_CreateCond();
+            _pool.finished  = SDL_CreateCond();
+        }
+
+        _pool.quit = false;
+        for (int i=1; i<ThreadPool::getNbThreads(); i++)
+        {
+            SDL_Thread * thread = SDL_CreateThread(&work, 0);
+            if (thread) { _pool.threads[_pool.nbThreads++] = thread; }
+        }
+    }
+    return (_pool.nbThreads>0);
+}
+
+/**
+ * Run a stage on the pool and wait for its end (the small stages are run by the calling thread)
+ * @param _task is the stage
+ * @param _size is the number of indices
+ * @param _grain is the number of indices of a chunk
+ */
+void ThreadPool::run(Task * _task, int _size, int _grain)
+{
+    Pool & pool = getPool();
+
+    // A STAGE RUN BY A TASK IS NOT SPLIT AGAIN
+    if (_grain<1) { _grain = 1; }
+    if (_size<=_grain || pool.task || !start(pool))
+    {
+        if (_size>0) { _task->run(0, _size); }
+    }
+    else
+    {
+        SDL_mutexP(pool.mutex);
+        pool.task   = _task;
+        pool.size   = _size;
+        pool.grain  = _grain;
+        pool.next   = 0;
+        pool.done   = 0;
+        pool.stage++;
+        SDL_CondBroadcast(pool.started);
+
+        runChunks(pool);
+        while (pool.done<pool.size) { SDL_CondWait(pool.finished, pool.mutex); }
+
+        pool.task = 0;
+        SDL_mutexV(pool.mutex);
+    }
+}
+
+/**
+ * Get the number of threads of the pool (caller included)
+ * @return the number of threads
+ */
+int ThreadPool::getNbThreads()
+{
+    static int nbThreads = 0;
+    if (!nbThreads)
+    {
+        long nbProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+        nbThreads = (nbProcessors<1)?1:(nbProcessors>nbThreadsMax?nbThreadsMax:nbProcessors);
+    }
+    return nbThreads;
+}
+
+/**
+ * Check if a stage is running (the nested stages are run serially)
+ * @return true if a stage is running
+ */
+bool ThreadPool::isRunning()
+{
+    // THE TASK IS SET BEFORE THE WORKERS ARE WOKEN UP AND RESET BY THE CALLING THREAD: NO LOCK NEEDED
+    return (getPool().task!=0);
+}
+
+/**
+ * Lock the global states shared by the tasks (only while a stage is running)
+ */
+ThreadPool::Guard::Guard():locked(isRunning())
+{
+    if (locked) { SDL_mutexP(getPool().shared); }
+}
+ThreadPool::Guard::~Guard()
+{
+    if (locked) { SDL_mutexV(getPool().shared); }
+}
+
+/**
+ * Stop the worker threads (they are started again by the next parallel stage)
+ */
+void ThreadPool::stop()
+{
+    Pool & pool = getPool();
+    if (pool.nbThreads)
+    {
+        SDL_mutexP(pool.mutex);
+        pool.quit = true;
+        SDL_CondBroadcast(pool.started);
+        SDL_mutexV(pool.mutex);
+
+        for (int i=0; i<pool.nbThreads; i++) { SDL_WaitThread(pool.threads[i], 0); }
+        pool.nbThreads = 0;
+    }
+}
@@ -21,6 +21,7 @@ SPLASHOUILLE.  If not, see http://www.gnu.org/licenses/
 #include <splashouilleImpl/Library.hpp>
 #include <splashouilleImpl/Engine.hpp>
 #include <splashouilleImpl/Event.hpp>
+#include <splashouilleImpl/Fashion.hpp>
 #include <splashouilleImpl/Timeline.hpp>
 #include <libconfig.h++>
 #include <iostream>
@@ -90,6 +91,22 @@ void Timeline::update(int _timestamp)
     }
 }
 
+/**
+ * Get the timestamp of the next event (the timeline has nothing to run before)
+ * @return the timestamp (Fashion::never if there is no event left)
+ */
+int Timeline::getWakeTimestamp() const
+{
+    int ret = Fashion::never;
+    if (eventIndex<events.size())
+    {
+        // THE EVENTS AT THE VERY BEGINNING ARE RUN EVEN BEFORE THE INITIAL TIMESTAMP
+        int eventTimestamp = events[eventIndex]->getTimeStampInMilliSeconds();
+        ret = (eventTimestamp>0)?animation->getInitialTimestamp()+eventTimestamp:-Fashion::never;
+    }
+    return ret;
+}
+
 /**
  * Clear the timeline
  */